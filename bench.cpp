@@ -0,0 +1,595 @@
+#include <benchmark/benchmark.h>
+
+#include "./status_optional.h"
+#include "./status_optional_batch.h"
+#include "./status_optional_reusable_message.h"
+#include "./status_optional_serialization.h"
+#include "./status_optional_warning_sink.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+
+#if __has_include(<expected>)
+#include <expected>
+#endif
+
+// Batch scans .
+namespace {
+
+constexpr std::size_t BatchSize = std::size_t(1) << 20;
+
+/*!
+ * \brief BatchErrorIndex is the position of the single error in the scanned batches, near the end so the scans read almost everything.
+ */
+constexpr std::size_t BatchErrorIndex = BatchSize - BatchSize / 16;
+
+std::vector<StatusOptional<int, std::string>> makeResults(bool withFailures) {
+    std::vector<StatusOptional<int, std::string>> ret;
+    ret.reserve(BatchSize);
+    for (std::size_t i = 0; i < BatchSize; i++) {
+        if (withFailures and i == BatchErrorIndex) {
+            ret.push_back(StatusOptional<int, std::string>::error("error"));
+        } else if (withFailures and i % 1000 == 999) {
+            ret.push_back(StatusOptional<int, std::string>::warning(int(i), "warning"));
+        } else {
+            ret.push_back(int(i));
+        }
+    }
+    return ret;
+}
+
+StatusOptionalBatch<int, std::string> makeBatch(std::vector<StatusOptional<int, std::string>> const& results) {
+    StatusOptionalBatch<int, std::string> ret;
+    ret.reserve(results.size());
+    for (StatusOptional<int, std::string> const& result : results) {
+        ret.push_back(result);
+    }
+    return ret;
+}
+
+/*!
+ * \brief vectorOfResults holds a warning every 1000 results and a single error at BatchErrorIndex.
+ */
+std::vector<StatusOptional<int, std::string>> const& vectorOfResults() {
+    static std::vector<StatusOptional<int, std::string>> results = makeResults(true);
+    return results;
+}
+
+StatusOptionalBatch<int, std::string> const& batchOfResults() {
+    static StatusOptionalBatch<int, std::string> results = makeBatch(vectorOfResults());
+    return results;
+}
+
+/*!
+ * \brief vectorOfValues only holds values, so all_ok has to scan everything.
+ */
+std::vector<StatusOptional<int, std::string>> const& vectorOfValues() {
+    static std::vector<StatusOptional<int, std::string>> results = makeResults(false);
+    return results;
+}
+
+StatusOptionalBatch<int, std::string> const& batchOfValues() {
+    static StatusOptionalBatch<int, std::string> results = makeBatch(vectorOfValues());
+    return results;
+}
+
+void BM_FirstErrorVector(benchmark::State& state) {
+    auto const& results = vectorOfResults();
+    for (auto _ : state) {
+        std::size_t index = results.size();
+        for (std::size_t i = 0; i < results.size(); i++) {
+            if (results[i].is_error()) {
+                index = i;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(index);
+    }
+    state.SetItemsProcessed(state.iterations() * BatchErrorIndex);
+}
+BENCHMARK(BM_FirstErrorVector);
+
+void BM_FirstErrorBatch(benchmark::State& state) {
+    auto const& results = batchOfResults();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(results.first_error_index());
+    }
+    state.SetItemsProcessed(state.iterations() * BatchErrorIndex);
+}
+BENCHMARK(BM_FirstErrorBatch);
+
+void BM_AllOkVector(benchmark::State& state) {
+    auto const& results = vectorOfValues();
+    for (auto _ : state) {
+        bool ok = true;
+        for (auto const& result : results) {
+            if (!result.is_no_error_or_warning()) {
+                ok = false;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_AllOkVector);
+
+void BM_AllOkBatch(benchmark::State& state) {
+    auto const& results = batchOfValues();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(results.all_ok());
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_AllOkBatch);
+
+void BM_CountErrorsVector(benchmark::State& state) {
+    auto const& results = vectorOfResults();
+    for (auto _ : state) {
+        std::size_t count = 0;
+        for (auto const& result : results) {
+            count += result.is_error();
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_CountErrorsVector);
+
+void BM_CountErrorsBatch(benchmark::State& state) {
+    auto const& results = batchOfResults();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(results.count_errors());
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_CountErrorsBatch);
+
+void BM_PartitionVector(benchmark::State& state) {
+    auto const& results = vectorOfResults();
+    for (auto _ : state) {
+        std::vector<std::size_t> ok;
+        std::vector<std::size_t> warnings;
+        std::vector<std::size_t> errors;
+        std::vector<std::size_t> invalid;
+        for (std::size_t i = 0; i < results.size(); i++) {
+            if (results[i].is_no_error_or_warning()) {
+                ok.push_back(i);
+            } else if (results[i].is_warning()) {
+                warnings.push_back(i);
+            } else if (results[i].is_error()) {
+                errors.push_back(i);
+            } else {
+                invalid.push_back(i);
+            }
+        }
+        benchmark::DoNotOptimize(ok.data());
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_PartitionVector);
+
+void BM_PartitionBatch(benchmark::State& state) {
+    auto const& results = batchOfResults();
+    for (auto _ : state) {
+        auto partition = results.partition_by_state();
+        benchmark::DoNotOptimize(partition.ok.data());
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_PartitionBatch);
+
+}
+
+// Serialization .
+namespace {
+
+/*!
+ * \brief BM_EncodeEach encodes the results of vectorOfResults one at a time, as a hand rolled encoder of each result would.
+ */
+void BM_EncodeEach(benchmark::State& state) {
+    auto const& results = vectorOfResults();
+    std::vector<unsigned char> buffer;
+    for (auto _ : state) {
+        buffer.clear();
+        for (StatusOptional<int, std::string> const& result : results) {
+            status_optional_encode(result, buffer);
+        }
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * results.size());
+}
+BENCHMARK(BM_EncodeEach);
+
+/*!
+ * \brief BM_EncodeBatch encodes the same results in a batch, copying the bitmasks and the values at once.
+ */
+void BM_EncodeBatch(benchmark::State& state) {
+    auto const& results = batchOfResults();
+    std::vector<unsigned char> buffer;
+    for (auto _ : state) {
+        buffer.clear();
+        status_optional_encode(results, buffer);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * results.size());
+}
+BENCHMARK(BM_EncodeBatch);
+
+/*!
+ * \brief BM_ReadViews checks the state of each encoded result with a StatusOptionalView, decoding only the values.
+ */
+void BM_ReadViews(benchmark::State& state) {
+    std::vector<unsigned char> buffer;
+    for (StatusOptional<int, std::string> const& result : vectorOfResults()) {
+        status_optional_encode(result, buffer);
+    }
+    for (auto _ : state) {
+        long sum = 0;
+        for (std::size_t offset = 0; offset < buffer.size();) {
+            StatusOptionalView<int, std::string> view(buffer.data() + offset, buffer.size() - offset);
+            if (view.has_value()) {
+                sum += view.value();
+            }
+            offset += view.encoded_size();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * vectorOfResults().size());
+}
+BENCHMARK(BM_ReadViews);
+
+void BM_DecodeBatch(benchmark::State& state) {
+    std::vector<unsigned char> buffer;
+    status_optional_encode(batchOfResults(), buffer);
+    for (auto _ : state) {
+        StatusOptionalBatch<int, std::string> decoded;
+        benchmark::DoNotOptimize(status_optional_decode_batch(buffer.data(), buffer.size(), decoded));
+    }
+    state.SetItemsProcessed(state.iterations() * batchOfResults().size());
+}
+BENCHMARK(BM_DecodeBatch);
+
+}
+
+// Storage reuse .
+namespace {
+
+/*!
+ * \brief BM_ReuseResult updates one result per row, one row in four being a warning with a message longer than the small string buffer.
+ *
+ * With a std::string message each warning allocates, with a ReusableMessage the buffer of the first warning is reused.
+ */
+template <typename MsgT>
+void BM_ReuseResult(benchmark::State& state) {
+    StatusOptional<int, MsgT> result;
+    for (auto _ : state) {
+        for (int i = 0; i < 1024; i++) {
+            if (i % 4 == 0) {
+                result.set_warning(i, "Value clamped to the range of the column");
+            } else {
+                result = i;
+            }
+            benchmark::DoNotOptimize(result);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK_TEMPLATE(BM_ReuseResult, std::string);
+BENCHMARK_TEMPLATE(BM_ReuseResult, ReusableMessage<>);
+
+}
+
+// Alternatives .
+namespace {
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE
+#endif
+
+constexpr std::size_t CallCount = 1024;
+
+/*!
+ * \brief SmallPayload returns an int, or a message short enough to be stored inline by std::string.
+ */
+struct SmallPayload {
+    using Value = int;
+    using Message = std::string;
+
+    static Value value(std::size_t i) {
+        return int(i);
+    }
+
+    static Message message() {
+        return "bad input";
+    }
+
+    static long weight(Value const& val) {
+        return val;
+    }
+};
+
+struct LargeValue {
+    std::array<std::uint64_t, 32> data;
+};
+
+/*!
+ * \brief LargePayload returns a 256 bytes value, or a message allocated on the heap.
+ */
+struct LargePayload {
+    using Value = LargeValue;
+    using Message = std::string;
+
+    static Value value(std::size_t i) {
+        LargeValue ret;
+        ret.data.fill(i);
+        return ret;
+    }
+
+    static Message message() {
+        return Message(64, 'e');
+    }
+
+    static long weight(Value const& val) {
+        return long(val.data[0]);
+    }
+};
+
+/*!
+ * \brief makeFailures draw which of the CallCount calls fail, with a fixed seed so all the alternatives see the same sequence.
+ */
+std::vector<char> makeFailures(int percent) {
+    std::mt19937 generator(42);
+    std::bernoulli_distribution failing(percent / 100.0);
+    std::vector<char> ret(CallCount);
+    for (char & failure : ret) {
+        failure = failing(generator);
+    }
+    return ret;
+}
+
+/*
+ * Each alternative returns the value or the error of a call from a function which is not inlined,
+ * moves the result once and checks it, counting the size of the message on failure.
+ */
+
+template <typename P>
+struct WithStatusOptional {
+    using Result = StatusOptional<typename P::Value, typename P::Message>;
+
+    BENCH_NOINLINE static Result make(std::size_t i, bool fail) {
+        if (fail) {
+            return Result::error(P::message());
+        }
+        return Result(P::value(i));
+    }
+
+    static long run(std::size_t i, bool fail) {
+        Result result(make(i, fail));
+        Result moved(std::move(result));
+        if (!moved.has_value()) {
+            return -long(moved.message().size());
+        }
+        return P::weight(moved.value());
+    }
+};
+
+template <typename P>
+struct WithOptional {
+    using Result = std::optional<typename P::Value>;
+
+    BENCH_NOINLINE static Result make(std::size_t i, bool fail) {
+        if (fail) {
+            return std::nullopt;
+        }
+        return Result(P::value(i));
+    }
+
+    static long run(std::size_t i, bool fail) {
+        Result result(make(i, fail));
+        Result moved(std::move(result));
+        if (!moved.has_value()) {
+            return -1;
+        }
+        return P::weight(*moved);
+    }
+};
+
+template <typename P>
+struct WithVariant {
+    using Result = std::variant<typename P::Value, typename P::Message>;
+
+    BENCH_NOINLINE static Result make(std::size_t i, bool fail) {
+        if (fail) {
+            return Result(std::in_place_index<1>, P::message());
+        }
+        return Result(std::in_place_index<0>, P::value(i));
+    }
+
+    static long run(std::size_t i, bool fail) {
+        Result result(make(i, fail));
+        Result moved(std::move(result));
+        if (moved.index() != 0) {
+            return -long(std::get<1>(moved).size());
+        }
+        return P::weight(std::get<0>(moved));
+    }
+};
+
+#if defined(__cpp_lib_expected)
+template <typename P>
+struct WithExpected {
+    using Result = std::expected<typename P::Value, typename P::Message>;
+
+    BENCH_NOINLINE static Result make(std::size_t i, bool fail) {
+        if (fail) {
+            return std::unexpected(P::message());
+        }
+        return Result(P::value(i));
+    }
+
+    static long run(std::size_t i, bool fail) {
+        Result result(make(i, fail));
+        Result moved(std::move(result));
+        if (!moved.has_value()) {
+            return -long(moved.error().size());
+        }
+        return P::weight(*moved);
+    }
+};
+#endif
+
+template <typename P>
+struct WithExceptions {
+    using Result = typename P::Value;
+
+    BENCH_NOINLINE static Result make(std::size_t i, bool fail) {
+        if (fail) {
+            throw P::message();
+        }
+        return P::value(i);
+    }
+
+    static long run(std::size_t i, bool fail) {
+        try {
+            Result result(make(i, fail));
+            Result moved(std::move(result));
+            return P::weight(moved);
+        } catch (typename P::Message const& message) {
+            return -long(message.size());
+        }
+    }
+};
+
+/*!
+ * \brief BM_Alternative run CallCount calls of an alternative, the argument is the percentage of failing calls.
+ */
+template <template <typename> class Alternative, typename P>
+void BM_Alternative(benchmark::State& state) {
+    std::vector<char> failures = makeFailures(int(state.range(0)));
+    for (auto _ : state) {
+        long sum = 0;
+        for (std::size_t i = 0; i < CallCount; i++) {
+            sum += Alternative<P>::run(i, failures[i]);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * CallCount);
+}
+
+#define ALTERNATIVE_BENCHMARK(Alternative) \
+    BENCHMARK_TEMPLATE(BM_Alternative, Alternative, SmallPayload)->ArgName("error_percent")->Arg(0)->Arg(1)->Arg(50); \
+    BENCHMARK_TEMPLATE(BM_Alternative, Alternative, LargePayload)->ArgName("error_percent")->Arg(0)->Arg(1)->Arg(50)
+
+ALTERNATIVE_BENCHMARK(WithStatusOptional);
+ALTERNATIVE_BENCHMARK(WithOptional);
+ALTERNATIVE_BENCHMARK(WithVariant);
+#if defined(__cpp_lib_expected)
+ALTERNATIVE_BENCHMARK(WithExpected);
+#endif
+ALTERNATIVE_BENCHMARK(WithExceptions);
+
+/*!
+ * \brief makeInState return a value (state 0), a warning (state 1) or an error (state 2).
+ */
+template <typename P>
+BENCH_NOINLINE StatusOptional<typename P::Value, typename P::Message> makeInState(std::size_t i, int state) {
+    using Result = StatusOptional<typename P::Value, typename P::Message>;
+    switch (state) {
+    case 0:
+        return Result(P::value(i));
+    case 1:
+        return Result::warning(P::value(i), P::message());
+    default:
+        return Result::error(P::message());
+    }
+}
+
+/*!
+ * \brief BM_States construct, return, move and check StatusOptional in each state, the argument is the state.
+ */
+template <typename P>
+void BM_States(benchmark::State& state) {
+    int resultState = int(state.range(0));
+    for (auto _ : state) {
+        long sum = 0;
+        for (std::size_t i = 0; i < CallCount; i++) {
+            StatusOptional<typename P::Value, typename P::Message> result(makeInState<P>(i, resultState));
+            StatusOptional<typename P::Value, typename P::Message> moved(std::move(result));
+            if (moved.has_value()) {
+                sum += P::weight(moved.value());
+            }
+            if (moved.has_message()) {
+                sum += long(moved.message().size());
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * CallCount);
+}
+BENCHMARK_TEMPLATE(BM_States, SmallPayload)->ArgName("state")->Arg(0)->Arg(1)->Arg(2);
+BENCHMARK_TEMPLATE(BM_States, LargePayload)->ArgName("state")->Arg(0)->Arg(1)->Arg(2);
+
+}
+
+// Warning sink .
+namespace {
+
+constexpr std::size_t WarningCount = 1024;
+
+/*!
+ * \brief BM_WarningsMutex hands the warnings of each thread over to a vector guarded by a mutex, as logging under a lock does.
+ */
+void BM_WarningsMutex(benchmark::State& state) {
+    static std::mutex mutex;
+    static std::vector<std::string> logged;
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < WarningCount; i++) {
+            auto result = StatusOptional<int, std::string>::warning(int(i), "warning");
+            if (result.is_warning()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                logged.push_back(std::move(result.message()));
+            }
+        }
+        if (state.thread_index() == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            logged.clear();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * WarningCount);
+}
+BENCHMARK(BM_WarningsMutex)->ThreadRange(1, 8)->UseRealTime();
+
+/*!
+ * \brief BM_WarningsSink hands the warnings over to a WarningSink, through a batching producer, the first thread draining it.
+ */
+void BM_WarningsSink(benchmark::State& state) {
+    static WarningSink<std::string> sink(1 << 16);
+    auto producer = sink.producer();
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < WarningCount; i++) {
+            auto result = StatusOptional<int, std::string>::warning(int(i), "warning");
+            producer.take_message(result);
+        }
+        if (state.thread_index() == 0) {
+            sink.drain([] (std::string && msg) { benchmark::DoNotOptimize(msg.data()); });
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * WarningCount);
+}
+BENCHMARK(BM_WarningsSink)->ThreadRange(1, 8)->UseRealTime();
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,37 @@
+#include STATUS_OPTIONAL_BUILDTIME_HEADER
+
+/*
+ * Compiled repeatedly by the status_optional_buildtime target, including each of the headers it compares
+ * (STATUS_OPTIONAL_BUILDTIME_HEADER), to measure what a header costs a translation unit which never uses
+ * std::string messages, as most of the code returning error codes does.
+ * It only uses the factories and accessors every version of the library has, so an older header can be compared.
+ */
+
+enum class ParseError {
+    Empty,
+    Overflow
+};
+
+StatusOptional<int, ParseError> parseDigit(char c);
+
+StatusOptional<long, ParseError> parseDoubled(char const* text) {
+    if (*text == '\0') {
+        return StatusOptional<long, ParseError>::error(ParseError::Empty);
+    }
+    StatusOptional<int, ParseError> digit = parseDigit(*text);
+    if (!digit.has_value()) {
+        return StatusOptional<long, ParseError>::error(digit.message());
+    }
+    return StatusOptional<long, ParseError>(2L*digit.value());
+}
+
+StatusOptional<void, ParseError> validate(char const* text) {
+    StatusOptional<long, ParseError> doubled = parseDoubled(text);
+    if (!doubled.has_value()) {
+        return StatusOptional<void, ParseError>::error(doubled.message());
+    }
+    if (doubled.value() > 10) {
+        return StatusOptional<void, ParseError>::error(ParseError::Overflow);
+    }
+    return StatusOptional<void, ParseError>();
+}
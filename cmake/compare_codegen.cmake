@@ -0,0 +1,50 @@
+# Compile SOURCE to assembly, and check that the functions whose names contain FUNCTION_A and FUNCTION_B
+# have the same instructions, once the local labels are renamed.
+#
+# The branch probabilities guessed from the shape of the source are disabled,
+# so the comparison is not sensitive to which function the early returns were written in.
+
+execute_process(
+  COMMAND ${CXX} -std=c++17 -O2 -fno-guess-branch-probability -S -I${INCLUDE_DIR} ${SOURCE} -o ${OUTPUT}
+  RESULT_VARIABLE result
+  ERROR_VARIABLE errors
+)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "Compiling ${SOURCE} failed:\n${errors}")
+endif()
+
+file(STRINGS ${OUTPUT} lines)
+
+function(extract_body name out)
+  set(inside FALSE)
+  set(body "")
+  foreach(line IN LISTS lines)
+    if (inside)
+      if (line MATCHES "\\.cfi_endproc")
+        break()
+      endif()
+      if (NOT line MATCHES "^\\.LFB|^\\.LFE|\\.cfi_")
+        string(REGEX REPLACE "\\.L[0-9]+" ".L" line "${line}")
+        list(APPEND body "${line}")
+      endif()
+    elseif (line MATCHES "^[_A-Za-z0-9.$]*${name}[_A-Za-z0-9.$]*:$")
+      set(inside TRUE)
+    endif()
+  endforeach()
+  if (NOT inside)
+    message(FATAL_ERROR "Function ${name} not found in ${OUTPUT}")
+  endif()
+  set(${out} "${body}" PARENT_SCOPE)
+endfunction()
+
+extract_body(${FUNCTION_A} bodyA)
+extract_body(${FUNCTION_B} bodyB)
+
+if (NOT bodyA STREQUAL bodyB)
+  string(REPLACE ";" "\n" bodyA "${bodyA}")
+  string(REPLACE ";" "\n" bodyB "${bodyB}")
+  message(FATAL_ERROR "${FUNCTION_A} and ${FUNCTION_B} do not compile to the same code:\n--- ${FUNCTION_A}\n${bodyA}\n--- ${FUNCTION_B}\n${bodyB}")
+endif()
+
+list(LENGTH bodyA count)
+message(STATUS "${FUNCTION_A} and ${FUNCTION_B} compile to the same ${count} lines of assembly")
@@ -0,0 +1,16 @@
+# Run PROGRAM with ARGUMENT, and check that it fails and prints EXPECTED on its error output.
+# ctest reports a program aborting as failed even for tests marked WILL_FAIL, hence this script.
+
+execute_process(
+  COMMAND ${PROGRAM} ${ARGUMENT}
+  RESULT_VARIABLE result
+  OUTPUT_QUIET
+  ERROR_VARIABLE errors
+)
+if (result EQUAL 0)
+  message(FATAL_ERROR "${PROGRAM} ${ARGUMENT} succeeded, it was expected to abort")
+endif()
+if (NOT errors MATCHES "${EXPECTED}")
+  message(FATAL_ERROR "${PROGRAM} ${ARGUMENT} failed (${result}) without printing \"${EXPECTED}\":\n${errors}")
+endif()
+message(STATUS "${PROGRAM} ${ARGUMENT} aborted as expected: ${errors}")
@@ -0,0 +1,38 @@
+# Compile SOURCE REPEAT times (5 by default) including each of the HEADERS in turn (as STATUS_OPTIONAL_BUILDTIME_HEADER),
+# and print the average wall clock time of a compilation and the number of preprocessed lines for each of them.
+
+if (NOT DEFINED REPEAT)
+  set(REPEAT 5)
+endif()
+
+foreach(header IN LISTS HEADERS)
+  set(definition "-DSTATUS_OPTIONAL_BUILDTIME_HEADER=\"${header}\"")
+
+  execute_process(
+    COMMAND ${CXX} -std=c++17 -E -I${INCLUDE_DIR} ${definition} ${SOURCE}
+    OUTPUT_VARIABLE preprocessed
+    RESULT_VARIABLE result
+    ERROR_VARIABLE errors
+  )
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Preprocessing ${SOURCE} with ${header} failed:\n${errors}")
+  endif()
+  string(REGEX MATCHALL "\n" lines "${preprocessed}")
+  list(LENGTH lines lineCount)
+
+  string(TIMESTAMP start "%s%f" UTC)
+  foreach(i RANGE 1 ${REPEAT})
+    execute_process(
+      COMMAND ${CXX} -std=c++17 -O2 -c -I${INCLUDE_DIR} ${definition} ${SOURCE} -o ${OUTPUT}
+      RESULT_VARIABLE result
+      ERROR_VARIABLE errors
+    )
+    if (NOT result EQUAL 0)
+      message(FATAL_ERROR "Compiling ${SOURCE} with ${header} failed:\n${errors}")
+    endif()
+  endforeach()
+  string(TIMESTAMP stop "%s%f" UTC)
+
+  math(EXPR average "(${stop} - ${start}) / (1000 * ${REPEAT})")
+  message(STATUS "${header}: ${average} ms per compilation, ${lineCount} preprocessed lines")
+endforeach()
@@ -0,0 +1,36 @@
+# Compile SOURCE to an object file, and print the size of the functions whose names start with each of FUNCTIONS,
+# as reported by nm. The parts of the functions moved out of line by the compiler (the .cold clones) are not counted.
+
+execute_process(
+  COMMAND ${CXX} -std=c++17 -O2 -c -I${INCLUDE_DIR} ${SOURCE} -o ${OUTPUT}
+  RESULT_VARIABLE result
+  ERROR_VARIABLE errors
+)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "Compiling ${SOURCE} failed:\n${errors}")
+endif()
+
+execute_process(
+  COMMAND ${NM} -S -C -t d ${OUTPUT}
+  OUTPUT_VARIABLE symbols
+  RESULT_VARIABLE result
+)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "Listing the symbols of ${OUTPUT} failed")
+endif()
+
+string(REPLACE "\n" ";" symbols "${symbols}")
+
+foreach(name IN LISTS FUNCTIONS)
+  set(found FALSE)
+  foreach(symbol IN LISTS symbols)
+    if (NOT symbol MATCHES "\\[clone" AND symbol MATCHES "^[0-9]+ 0*([0-9]+) [Tt] ${name}\\(")
+      set(size ${CMAKE_MATCH_1})
+      message(STATUS "${name}: ${size} bytes")
+      set(found TRUE)
+    endif()
+  endforeach()
+  if (NOT found)
+    message(FATAL_ERROR "Function ${name} not found in ${OUTPUT}")
+  endif()
+endforeach()
@@ -0,0 +1,25 @@
+#include "./status_optional_try.h"
+
+/*
+ * Compiled to assembly by the status_optional_codegen_try test, which checks that the function using
+ * STATUS_OPTIONAL_TRY_ASSIGN has the same instructions as the function with the hand written branch.
+ */
+
+StatusOptional<int, std::string> parseCount(char const* text);
+
+StatusOptional<long, std::string> doubledCountViaMacro(char const* text) {
+    STATUS_OPTIONAL_TRY_ASSIGN(int count, parseCount(text));
+    return 2 * static_cast<long>(count);
+}
+
+StatusOptional<long, std::string> doubledCountViaBranch(char const* text) {
+    StatusOptional<int, std::string> parsed = parseCount(text);
+    if (!parsed.has_value()) {
+        if (parsed.has_message()) {
+            return StatusOptional<long, std::string>::error(std::move(parsed.message()));
+        }
+        return StatusOptional<long, std::string>();
+    }
+    int count = parsed.value();
+    return 2 * static_cast<long>(count);
+}
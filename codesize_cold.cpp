@@ -0,0 +1,53 @@
+#include "./status_optional.h"
+
+#include <cstddef>
+#include <string>
+
+/*
+ * Compiled by the status_optional_codesize target, which reports the size of the two loops below:
+ * they only differ by the error message being built inline or by StatusOptional::error_from, out of line.
+ */
+
+namespace {
+
+inline StatusOptional<int, std::string> checkedInline(int value, std::size_t index) {
+    if (value < 0) {
+        return StatusOptional<int, std::string>::error("negative value " + std::to_string(value) + " at index " + std::to_string(index));
+    }
+    return value;
+}
+
+inline StatusOptional<int, std::string> checkedOutOfLine(int value, std::size_t index) {
+    if (value < 0) {
+        return StatusOptional<int, std::string>::error_from([&] () {
+            return "negative value " + std::to_string(value) + " at index " + std::to_string(index);
+        });
+    }
+    return value;
+}
+
+}
+
+long sumWithInlineError(int const* values, std::size_t count) {
+    long sum = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        StatusOptional<int, std::string> checked = checkedInline(values[i], i);
+        if (!checked.has_value()) {
+            return -1;
+        }
+        sum += checked.value();
+    }
+    return sum;
+}
+
+long sumWithOutOfLineError(int const* values, std::size_t count) {
+    long sum = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        StatusOptional<int, std::string> checked = checkedOutOfLine(values[i], i);
+        if (!checked.has_value()) {
+            return -1;
+        }
+        sum += checked.value();
+    }
+    return sum;
+}
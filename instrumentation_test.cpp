@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#define STATUS_OPTIONAL_INSTRUMENTATION
+#include "./status_optional.h"
+#include "./status_optional_static_message.h"
+#include "./status_optional_batch.h"
+#include "./status_optional_algorithm.h"
+#include "./status_optional_try.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+/*
+ * Built as status_optional_instrumentation_test, separately from test.cpp,
+ * since STATUS_OPTIONAL_INSTRUMENTATION changes the signature of the factories.
+ */
+
+namespace {
+
+StatusOptionalSiteCount countsAt(std::uint_least32_t line) {
+    for (StatusOptionalSiteCount const& count : status_optional_site_counts()) {
+        if (count.site.line == line and std::strstr(count.site.file, "instrumentation_test.cpp") != nullptr) {
+            return count;
+        }
+    }
+    return StatusOptionalSiteCount{StatusOptionalSite::unknown(), 0, 0};
+}
+
+StatusOptional<int, std::string> checkPositive(int value) {
+    if (value < 0) {
+        return StatusOptional<int, std::string>::error("negative");
+    }
+    if (value == 0) {
+        return StatusOptional<int, std::string>::warning(value, "zero");
+    }
+    return value;
+}
+
+constexpr std::uint_least32_t CheckPositiveErrorLine = __LINE__ - 8;
+constexpr std::uint_least32_t CheckPositiveWarningLine = __LINE__ - 6;
+
+std::vector<StatusOptionalSite> hookedSites;
+
+void recordHook(StatusOptionalSite const& site, StatusOptionalEvent event) {
+    if (event == StatusOptionalEvent::Error) {
+        hookedSites.push_back(site);
+    }
+}
+
+}
+
+// Instrumentation .
+TEST(StatusOptional, InstrumentationCountsSites) {
+
+    status_optional_reset_site_counts();
+
+    for (int i = -3; i < 5; i++) {
+        checkPositive(i);
+    }
+
+    StatusOptionalSiteCount errors = countsAt(CheckPositiveErrorLine);
+    ASSERT_EQ(errors.errors, 3u);
+    ASSERT_EQ(errors.warnings, 0u);
+
+    StatusOptionalSiteCount warnings = countsAt(CheckPositiveWarningLine);
+    ASSERT_EQ(warnings.warnings, 1u);
+    ASSERT_EQ(warnings.errors, 0u);
+
+    auto voidError = StatusOptional<void, std::string>::error_from([] () { return std::string("failed"); });
+    std::uint_least32_t errorFromLine = __LINE__ - 1;
+    ASSERT_TRUE(voidError.is_error());
+    ASSERT_EQ(countsAt(errorFromLine).errors, 1u);
+
+    status_optional_reset_site_counts();
+    ASSERT_EQ(countsAt(CheckPositiveErrorLine).errors, 0u);
+}
+
+TEST(StatusOptional, InstrumentationConcurrentCounts) {
+
+    status_optional_reset_site_counts();
+
+    constexpr int ThreadCount = 4;
+    constexpr int CallCount = 10000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadCount; t++) {
+        threads.emplace_back([] () {
+            for (int i = 0; i < CallCount; i++) {
+                checkPositive(-1);
+            }
+        });
+    }
+    for (std::thread & thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(countsAt(CheckPositiveErrorLine).errors, std::uint64_t(ThreadCount) * CallCount);
+}
+
+TEST(StatusOptional, InstrumentationHook) {
+
+    StatusOptionalHook previous = status_optional_set_hook(&recordHook);
+    ASSERT_EQ(previous, status_optional_default_hook());
+
+    status_optional_reset_site_counts();
+    hookedSites.clear();
+
+    checkPositive(-1);
+    checkPositive(0);
+    StatusOptional<int, std::string>::error_in_place(3, 'x');
+
+    ASSERT_EQ(hookedSites.size(), 2u);
+    ASSERT_EQ(hookedSites[0].line, CheckPositiveErrorLine);
+    ASSERT_EQ(hookedSites[1].line, 0u);
+    ASSERT_EQ(countsAt(CheckPositiveErrorLine).errors, 0u);
+
+    status_optional_set_hook(nullptr);
+    checkPositive(-1);
+    ASSERT_EQ(hookedSites.size(), 2u);
+
+    status_optional_set_hook(previous);
+}
+
+TEST(StatusOptional, InstrumentationVariadicFactories) {
+
+    std::vector<StatusOptionalSite> sites;
+    static std::vector<StatusOptionalSite>* recorded = nullptr;
+    recorded = &sites;
+
+    StatusOptionalHook previous = status_optional_set_hook([] (StatusOptionalSite const& site, StatusOptionalEvent) {
+        recorded->push_back(site);
+    });
+
+    std::allocator<char> alloc;
+    StatusOptional<int, std::string>::error_in_place(3, 'x');
+    StatusOptional<int, std::string>::warning(std::allocator_arg, alloc, 1, "allocated");
+    StatusOptional<int, std::string>::error(std::allocator_arg, alloc, "allocated");
+    StatusOptional<void, std::string>::warning_in_place(3, 'x');
+    StatusOptional<void, std::string>::error_in_place(3, 'x');
+    StatusOptional<int&, std::string>::error_in_place(3, 'x');
+
+    // the variadic factories are reported, without their site
+    ASSERT_EQ(sites.size(), 6u);
+    for (StatusOptionalSite const& site : sites) {
+        ASSERT_EQ(site.line, 0u);
+        ASSERT_STREQ(site.file, "");
+        ASSERT_STREQ(site.function, "");
+    }
+
+    // the piecewise warning_in_place and the factories taking a message capture it
+    sites.clear();
+    int val = 0;
+    StatusOptional<int, std::string>::warning_in_place(std::piecewise_construct, std::forward_as_tuple(1), std::forward_as_tuple(3, 'x'));
+    std::uint_least32_t piecewiseLine = __LINE__ - 1;
+    StatusOptional<int&, std::string>::warning(val, std::string(3, 'x'));
+    std::uint_least32_t warningLine = __LINE__ - 1;
+
+    ASSERT_EQ(sites.size(), 2u);
+    ASSERT_EQ(sites[0].line, piecewiseLine);
+    ASSERT_EQ(sites[1].line, warningLine);
+    ASSERT_NE(std::strstr(sites[1].file, "instrumentation_test.cpp"), nullptr);
+
+    status_optional_set_hook(previous);
+}
+
+TEST(StatusOptional, InstrumentationConstantExpressions) {
+    constexpr auto error = StatusOptional<int, StaticMessage>::error("constant");
+    static_assert(error.is_error());
+    constexpr auto warning = StatusOptional<void, StaticMessage>::warning("constant");
+    static_assert(warning.is_warning());
+}
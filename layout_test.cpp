@@ -0,0 +1,168 @@
+#include "./status_optional.h"
+#include "./status_optional_static_message.h"
+#include "./status_optional_cold_message.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/*
+ * Compile time checks of the layout of StatusOptional, built by the status_optional_layout_test target.
+ *
+ * A failure here means the storage representation changed: update the expectations below
+ * together with the change, so the size (and calling convention) implications are reviewed explicitly.
+ */
+
+namespace {
+
+enum class ErrCode : int {
+    None,
+    NotFound,
+    Denied
+};
+
+enum class ErrCode64 : std::uint64_t {
+    None,
+    Failed
+};
+
+struct Entry {
+    int id;
+};
+
+struct Large {
+    char data[40];
+};
+
+struct ThrowingMove {
+    ThrowingMove() = default;
+    ThrowingMove(ThrowingMove const&) {}
+    ThrowingMove(ThrowingMove &&) noexcept(false) {}
+    ThrowingMove& operator=(ThrowingMove const&) { return *this; }
+    ThrowingMove& operator=(ThrowingMove &&) noexcept(false) { return *this; }
+};
+
+}
+
+template <>
+struct status_optional_niche<Entry*> : status_optional_sentinel_niche<Entry*, nullptr> {};
+
+template <>
+struct status_optional_niche<ErrCode64> : status_optional_sentinel_niche<ErrCode64, ErrCode64::None> {};
+
+namespace {
+
+/*!
+ * \brief ReferenceLayout is the layout StatusOptional<T, MsgT> must match: the value, the message, and a state byte.
+ */
+template <typename T, typename MsgT>
+struct ReferenceLayout {
+    T value;
+    MsgT message;
+    std::uint8_t state;
+};
+
+template <typename MsgT>
+struct ReferenceLayout<void, MsgT> {
+    MsgT message;
+    std::uint8_t state;
+};
+
+/*!
+ * \brief NicheLayout is the layout of StatusOptional<T, MsgT> when both payloads have a niche: no state byte.
+ */
+template <typename T, typename MsgT>
+struct NicheLayout {
+    T value;
+    MsgT message;
+};
+
+template <typename T>
+using ValueOrEmpty = std::conditional_t<std::is_void_v<T>, std::uint8_t, T>;
+
+template <typename T, typename MsgT>
+constexpr bool propagates_traits() {
+    using SO = StatusOptional<T, MsgT>;
+    using V = ValueOrEmpty<T>;
+    static_assert(std::is_trivially_copyable_v<SO> == (std::is_trivially_copyable_v<V> and std::is_trivially_copyable_v<MsgT>),
+                  "StatusOptional must be trivially copyable exactly when its payloads are");
+    static_assert(std::is_trivially_destructible_v<SO> == (std::is_trivially_destructible_v<V> and std::is_trivially_destructible_v<MsgT>),
+                  "StatusOptional must be trivially destructible exactly when its payloads are");
+    static_assert(std::is_nothrow_move_constructible_v<SO> == (std::is_nothrow_move_constructible_v<V> and std::is_nothrow_move_constructible_v<MsgT>),
+                  "StatusOptional must be nothrow move constructible exactly when its payloads are");
+    static_assert(std::is_copy_constructible_v<SO> == (std::is_copy_constructible_v<V> and std::is_copy_constructible_v<MsgT>),
+                  "StatusOptional must be copy constructible exactly when its payloads are");
+    static_assert(alignof(SO) == alignof(ReferenceLayout<T, MsgT>), "StatusOptional must not be over aligned");
+    return true;
+}
+
+template <typename T, typename MsgT>
+constexpr bool has_reference_layout() {
+    static_assert(propagates_traits<T, MsgT>());
+    static_assert(sizeof(StatusOptional<T, MsgT>) == sizeof(ReferenceLayout<T, MsgT>),
+                  "StatusOptional must only add a state byte (and its padding) to its payloads");
+    return true;
+}
+
+template <typename T, typename MsgT>
+constexpr bool has_niche_layout() {
+    static_assert(propagates_traits<T, MsgT>());
+    static_assert(sizeof(StatusOptional<T, MsgT>) == sizeof(NicheLayout<T, MsgT>),
+                  "StatusOptional must store its state in the niches of its payloads");
+    return true;
+}
+
+// Trivial payloads .
+static_assert(has_reference_layout<int, ErrCode>());
+static_assert(has_reference_layout<int, int>());
+static_assert(has_reference_layout<char, char>());
+static_assert(has_reference_layout<double, ErrCode>());
+static_assert(has_reference_layout<Large, ErrCode>());
+static_assert(has_reference_layout<int*, ErrCode>());
+static_assert(has_reference_layout<int, StaticMessage>());
+static_assert(has_reference_layout<int, StatusCode>());
+
+static_assert(sizeof(StatusOptional<int, ErrCode>) == 3 * sizeof(int));
+static_assert(sizeof(StatusOptional<char, char>) == 3);
+
+// StatusOptional<int, ErrCode> is returned in two registers on the 64 bits ABIs.
+static_assert(sizeof(void*) != 8 or sizeof(StatusOptional<int, ErrCode>) <= 2 * sizeof(void*));
+
+// Non trivial payloads .
+static_assert(has_reference_layout<int, std::string>());
+static_assert(has_reference_layout<std::string, std::string>());
+static_assert(has_reference_layout<std::vector<int>, ErrCode>());
+static_assert(has_reference_layout<std::unique_ptr<int>, ErrCode>());
+static_assert(has_reference_layout<int, ColdMessage<std::string>>());
+static_assert(has_reference_layout<ThrowingMove, ErrCode>());
+static_assert(has_reference_layout<int, ThrowingMove>());
+
+static_assert(sizeof(StatusOptional<int, ColdMessage<std::string>>) == 3 * sizeof(void*));
+
+// Void specialization .
+static_assert(has_reference_layout<void, ErrCode>());
+static_assert(has_reference_layout<void, char>());
+static_assert(has_reference_layout<void, std::string>());
+static_assert(has_reference_layout<void, StaticMessage>());
+
+static_assert(sizeof(StatusOptional<void, ErrCode>) == 2 * sizeof(ErrCode));
+static_assert(sizeof(StatusOptional<void, char>) == 2);
+
+// Niche optimization .
+static_assert(has_niche_layout<Entry*, ErrCode64>());
+static_assert(sizeof(StatusOptional<Entry*, ErrCode64>) == sizeof(Entry*) + sizeof(ErrCode64));
+static_assert(has_reference_layout<void, ErrCode64>());
+
+// Reference specialization, stored as a pointer .
+static_assert(sizeof(StatusOptional<int&, ErrCode>) == sizeof(ReferenceLayout<int*, ErrCode>));
+static_assert(sizeof(StatusOptional<Large const&, std::string>) == sizeof(ReferenceLayout<Large const*, std::string>));
+static_assert(std::is_trivially_copyable_v<StatusOptional<Large&, ErrCode>>);
+static_assert(sizeof(StatusOptional<Entry&, ErrCode64>) == sizeof(Entry*) + sizeof(ErrCode64));
+
+}
+
+int main() {
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include <string>
+
+import status_optional;
+
+/*
+ * Built against the status_optional named module by the status_optional_module_test test (BUILD_MODULE),
+ * it returns 0 once the exported names have been used from a translation unit which does not include the headers.
+ */
+
+int main() {
+
+    StatusOptional<int> warning = StatusOptional<int>::warning(3, "warning");
+    StatusOptional<int, StaticMessage> error = StatusOptional<int, StaticMessage>::error("error");
+    StatusOptional<void, ReusableMessage<>> status;
+    status.set_warning("careful");
+
+    auto doubled = warning.transform([] (int val) { return 2*val; });
+
+    bool ok = doubled.value() == 6 and
+              doubled.message() == "warning" and
+              error.is_error() and
+              status.is_warning() and
+              warning.state() == StatusOptionalState::Warning;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,44 @@
+#include "./status_optional.h"
+#include "./status_optional_batch.h"
+
+#include <cstring>
+#include <string>
+
+/*
+ * Built with -fno-exceptions and STATUS_OPTIONAL_DEBUG by the status_optional_noexceptions tests.
+ *
+ * Without argument it reads the payloads which are there with the checked and the unchecked accessors, and returns 0.
+ * With "unchecked" or "checked" it reads the value of an error with operator* or with value(),
+ * which must abort: those tests are expected to fail.
+ */
+
+int main(int argc, char** argv) {
+
+    auto warning = StatusOptional<int, std::string>::warning(3, "warning");
+    auto error = StatusOptional<int, std::string>::error("error");
+    auto voidError = StatusOptional<void, std::string>::error("error");
+
+    StatusOptionalBatch<int, std::string> batch;
+    batch.push_back(warning);
+    batch.push_back(error);
+
+    if (argc > 1 and std::strcmp(argv[1], "unchecked") == 0) {
+        return *error;
+    }
+
+    if (argc > 1 and std::strcmp(argv[1], "checked") == 0) {
+        return error.value();
+    }
+
+    bool ok = *warning == 3 and
+              warning.value() == 3 and
+              warning.unchecked_value() == 3 and
+              warning.unchecked_message() == "warning" and
+              error.message() == "error" and
+              error.unchecked_message() == "error" and
+              voidError.unchecked_message() == "error" and
+              batch[0].value() == 3 and
+              batch[1].is_valid();
+
+    return ok ? 0 : 1;
+}
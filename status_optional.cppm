@@ -0,0 +1,37 @@
+module;
+
+#include "./status_optional.h"
+#include "./status_optional_static_message.h"
+#include "./status_optional_lazy_message.h"
+#include "./status_optional_cold_message.h"
+#include "./status_optional_reusable_message.h"
+#include "./status_optional_warning_list.h"
+#include "./status_optional_batch.h"
+
+/*
+ * The status_optional named module, built by the status_optional_module target (BUILD_MODULE).
+ *
+ * It exports StatusOptional, with std::string as default message type, its customization points and the message types.
+ * Macros cannot be exported: the code using STATUS_OPTIONAL_TRY or the instrumentation keeps including the headers.
+ */
+
+export module status_optional;
+
+export using ::StatusOptional;
+export using ::StatusOptionalState;
+export using ::status_message_traits;
+export using ::status_message_merge;
+export using ::status_message_reuse;
+export using ::status_optional_niche;
+export using ::status_optional_sentinel_niche;
+export using ::status_optional_nan_niche;
+
+export using ::StaticMessage;
+export using ::StatusCategory;
+export using ::StatusCode;
+export using ::LazyMessage;
+export using ::ColdMessage;
+export using ::ReusableMessage;
+export using ::WarningList;
+export using ::merge_warnings;
+export using ::StatusOptionalBatch;
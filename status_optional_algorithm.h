@@ -0,0 +1,255 @@
+#ifndef STATUS_OPTIONAL_ALGORITHM_H
+#define STATUS_OPTIONAL_ALGORITHM_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<execution>)
+#include <execution>
+#endif
+
+#include "./status_optional.h"
+
+namespace status_optional_detail {
+
+template <typename U, typename MsgT>
+using CollectResult = StatusOptional<std::conditional_t<std::is_void_v<U>, void, std::vector<U>>, MsgT>;
+
+template <typename U>
+struct CollectValues {
+    std::vector<U> _values;
+};
+
+template <>
+struct CollectValues<void> {
+};
+
+/*!
+ * \brief The Collector struct accumulates the values and warnings of a sequence of StatusOptional<U, MsgT>.
+ */
+template <typename U, typename MsgT>
+struct Collector : CollectValues<U> {
+
+    using Ret = CollectResult<U, MsgT>;
+
+    void reserve(std::size_t count) {
+        if constexpr (!std::is_void_v<U>) {
+            this->_values.reserve(count);
+        }
+    }
+
+    /*!
+     * \brief push append the value of the valid element, or return false if it is an error or is invalid.
+     */
+    template <typename Element>
+    bool push(Element && element) {
+        if (!Access::succeeded(element)) {
+            return false;
+        }
+        if constexpr (!std::is_void_v<U>) {
+            this->_values.push_back(Access::stored_value(std::forward<Element>(element)));
+        }
+        if (element.has_message()) {
+            add_warning(Access::stored_message(std::forward<Element>(element)));
+        }
+        return true;
+    }
+
+    template <typename M>
+    void add_warning(M && msg) {
+        if (_warning.has_value()) {
+            MsgT copy(std::forward<M>(msg));
+            status_message_merge<MsgT>::merge(*_warning, std::move(copy));
+        } else {
+            _warning.emplace(std::forward<M>(msg));
+        }
+    }
+
+    Ret finish() && {
+        if constexpr (std::is_void_v<U>) {
+            if (_warning.has_value()) {
+                return Ret::warning(std::move(*_warning));
+            }
+            return Ret();
+        } else {
+            if (_warning.has_value()) {
+                return Ret::warning(std::move(this->_values), std::move(*_warning));
+            }
+            return Ret(std::move(this->_values));
+        }
+    }
+
+    std::optional<MsgT> _warning;
+};
+
+template <typename It, typename Project>
+auto gather(It first, It last, Project && project) {
+    using Element = remove_cvref_t<decltype(project(first))>;
+    static_assert(is_status_optional<Element>::value, "collect and traverse expect ranges of StatusOptional");
+    using U = typename Element::ValueType;
+    using MsgT = typename Element::MessageType;
+
+    Collector<U, MsgT> collector;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>) {
+        collector.reserve(static_cast<std::size_t>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+        decltype(auto) element = project(first);
+        if (!collector.push(std::forward<decltype(element)>(element))) {
+            return Access::failure_from<CollectResult<U, MsgT>>(std::forward<decltype(element)>(element));
+        }
+    }
+    return std::move(collector).finish();
+}
+
+#if defined(__cpp_lib_execution)
+
+/*!
+ * \brief parallel_gather is gather running project on the elements with an execution policy.
+ *
+ * The output is allocated once. The elements after the first failure seen so far are skipped,
+ * while the elements before it are still evaluated, so the failure returned is always the first one of the range,
+ * and the warnings are merged in the order of the range.
+ */
+template <typename ExecutionPolicy, typename It, typename Project>
+auto parallel_gather(ExecutionPolicy && policy, It first, It last, Project && project) {
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>,
+                  "parallel collect and traverse require random access iterators");
+
+    using Element = remove_cvref_t<decltype(project(first))>;
+    static_assert(is_status_optional<Element>::value, "collect and traverse expect ranges of StatusOptional");
+    using U = typename Element::ValueType;
+    using MsgT = typename Element::MessageType;
+    using Ret = CollectResult<U, MsgT>;
+    static_assert(std::is_void_v<U> or std::is_default_constructible_v<U>, "parallel collect and traverse preallocate the output, the value type must be default constructible");
+    static_assert(!std::is_same_v<U, bool>, "parallel collect and traverse write the output concurrently, which std::vector<bool> does not support");
+
+    constexpr std::size_t ChunkSize = 256;
+
+    std::size_t count = static_cast<std::size_t>(last - first);
+    std::size_t chunkCount = (count + ChunkSize - 1) / ChunkSize;
+
+    Collector<U, MsgT> collector;
+    if constexpr (!std::is_void_v<U>) {
+        collector._values.resize(count);
+    }
+
+    std::vector<std::size_t> chunks(chunkCount);
+    for (std::size_t c = 0; c < chunkCount; c++) {
+        chunks[c] = c;
+    }
+
+    std::atomic<std::size_t> failureIndex(count);
+    std::mutex mutex;
+    std::optional<Ret> failure;
+    std::vector<std::pair<std::size_t, MsgT>> warnings;
+
+    std::for_each(std::forward<ExecutionPolicy>(policy), chunks.begin(), chunks.end(), [&] (std::size_t c) {
+        std::size_t end = std::min(count, (c + 1) * ChunkSize);
+        for (std::size_t i = c * ChunkSize; i < end; i++) {
+            if (i > failureIndex.load(std::memory_order_relaxed)) {
+                return;
+            }
+            decltype(auto) element = project(first + i);
+            if (!Access::succeeded(element)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (i < failureIndex.load(std::memory_order_relaxed)) {
+                    failureIndex.store(i, std::memory_order_relaxed);
+                    failure.emplace(Access::failure_from<Ret>(std::forward<decltype(element)>(element)));
+                }
+                return;
+            }
+            if constexpr (!std::is_void_v<U>) {
+                collector._values[i] = Access::stored_value(std::forward<decltype(element)>(element));
+            }
+            if (element.has_message()) {
+                std::lock_guard<std::mutex> lock(mutex);
+                warnings.emplace_back(i, Access::stored_message(std::forward<decltype(element)>(element)));
+            }
+        }
+    });
+
+    if (failure.has_value()) {
+        return std::move(*failure);
+    }
+
+    std::sort(warnings.begin(), warnings.end(), [] (auto const& a, auto const& b) { return a.first < b.first; });
+    for (auto & warning : warnings) {
+        collector.add_warning(std::move(warning.second));
+    }
+    return std::move(collector).finish();
+}
+
+template <typename ExecutionPolicy>
+constexpr bool is_execution_policy_v = std::is_execution_policy_v<remove_cvref_t<ExecutionPolicy>>;
+
+#else
+
+template <typename ExecutionPolicy>
+constexpr bool is_execution_policy_v = false;
+
+#endif
+
+} // namespace status_optional_detail
+
+/*!
+ * \brief collect turn a range of StatusOptional<U, MsgT> into a StatusOptional<std::vector<U>, MsgT>.
+ *
+ * The result is the first error (or invalid element) of the range, or all the values, with the warnings of the range
+ * merged by status_message_merge<MsgT> into a single warning. The values are copied from the range,
+ * pass std::move_iterator to move them instead. collect of a range of StatusOptional<void, MsgT> returns a StatusOptional<void, MsgT>.
+ */
+template <typename It,
+          std::enable_if_t<!status_optional_detail::is_execution_policy_v<It>, bool> = true>
+auto collect(It first, It last) {
+    return status_optional_detail::gather(first, last, [] (It const& it) -> decltype(auto) { return *it; });
+}
+
+/*!
+ * \brief traverse apply f to each element of a range, and collect the resulting StatusOptional<U, MsgT> without storing them.
+ *
+ * It stops at the first error, as collect(first, last) would on the results of f.
+ */
+template <typename It, typename F,
+          std::enable_if_t<!status_optional_detail::is_execution_policy_v<It>, bool> = true>
+auto traverse(It first, It last, F && f) {
+    return status_optional_detail::gather(first, last, [&f] (It const& it) { return status_optional_detail::invoke(f, *it); });
+}
+
+#if defined(__cpp_lib_execution)
+
+/*!
+ * \brief collect, running with an execution policy.
+ *
+ * The iterators must be random access and the value type default constructible, as the output is allocated upfront.
+ * Once an error is found, the elements after it are not read.
+ */
+template <typename ExecutionPolicy, typename It,
+          std::enable_if_t<status_optional_detail::is_execution_policy_v<ExecutionPolicy>, bool> = true>
+auto collect(ExecutionPolicy && policy, It first, It last) {
+    return status_optional_detail::parallel_gather(std::forward<ExecutionPolicy>(policy), first, last, [] (It const& it) -> decltype(auto) { return *it; });
+}
+
+/*!
+ * \brief traverse, running with an execution policy.
+ *
+ * f is called concurrently on different elements. Once an error is found, f is not called on the elements after it anymore.
+ */
+template <typename ExecutionPolicy, typename It, typename F,
+          std::enable_if_t<status_optional_detail::is_execution_policy_v<ExecutionPolicy>, bool> = true>
+auto traverse(ExecutionPolicy && policy, It first, It last, F && f) {
+    return status_optional_detail::parallel_gather(std::forward<ExecutionPolicy>(policy), first, last,
+                                                   [&f] (It const& it) { return status_optional_detail::invoke(f, *it); });
+}
+
+#endif
+
+#endif // STATUS_OPTIONAL_ALGORITHM_H
@@ -0,0 +1,40 @@
+#ifndef STATUS_OPTIONAL_ALLOCATOR_H
+#define STATUS_OPTIONAL_ALLOCATOR_H
+
+#include <memory>
+#include <utility>
+
+#include "./status_optional_core.h"
+
+/*!
+ * \file status_optional_allocator.h
+ *
+ * The uses-allocator construction of the payloads, used by the allocator aware constructors and factories of StatusOptional
+ * (the ones taking std::allocator_arg). It is kept out of status_optional_core.h, which does not include <memory>,
+ * and status_optional.h includes it.
+ */
+
+namespace status_optional_detail {
+
+/*!
+ * The allocator is ignored if T does not use it, and passed after std::allocator_arg or last otherwise.
+ */
+template <typename T, typename Alloc>
+struct UsesAllocator {
+
+    template <typename... Args>
+    static constexpr T make(Alloc const& alloc, Args&&... args) {
+        if constexpr (!std::uses_allocator_v<T, Alloc>) {
+            return T(std::forward<Args>(args)...);
+        } else if constexpr (std::is_constructible_v<T, std::allocator_arg_t, Alloc const&, Args&&...>) {
+            return T(std::allocator_arg, alloc, std::forward<Args>(args)...);
+        } else {
+            static_assert(std::is_constructible_v<T, Args&&..., Alloc const&>, "The type uses the allocator but has no allocator aware constructor for these arguments");
+            return T(std::forward<Args>(args)..., alloc);
+        }
+    }
+};
+
+} // namespace status_optional_detail
+
+#endif // STATUS_OPTIONAL_ALLOCATOR_H
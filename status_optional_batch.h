@@ -0,0 +1,673 @@
+#ifndef STATUS_OPTIONAL_BATCH_H
+#define STATUS_OPTIONAL_BATCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if !defined(STATUS_OPTIONAL_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STATUS_OPTIONAL_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STATUS_OPTIONAL_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define STATUS_OPTIONAL_SIMD_NEON
+#endif
+#endif
+
+#include "./status_optional.h"
+
+namespace status_optional_detail {
+
+inline int popcount64(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    while (word != 0) {
+        word &= word - 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/*!
+ * \brief countr_zero64 returns the index of the lowest set bit of word, which must not be 0.
+ */
+inline int countr_zero64(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int count = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+/*!
+ * \brief Word predicates over the value and message bitmasks of a batch.
+ *
+ * ErrorWord has the bits of the errors set (message without value),
+ * NotOkWord the bits of the elements which are not valid without message (including the bits past the end of the batch).
+ */
+enum class ScanPredicate {
+    ErrorWord,
+    NotOkWord
+};
+
+template <ScanPredicate Predicate>
+inline std::uint64_t scan_word(std::uint64_t valueWord, std::uint64_t messageWord) {
+    if constexpr (Predicate == ScanPredicate::ErrorWord) {
+        return ~valueWord & messageWord;
+    } else {
+        return ~valueWord | messageWord;
+    }
+}
+
+/*!
+ * \brief first_word_scalar returns the index of the first of the count words for which Predicate is non zero, or count.
+ */
+template <ScanPredicate Predicate>
+inline std::size_t first_word_scalar(std::uint64_t const* values, std::uint64_t const* messages, std::size_t count, std::size_t start = 0) {
+    for (std::size_t i = start; i < count; i++) {
+        if (scan_word<Predicate>(values[i], messages[i]) != 0) {
+            return i;
+        }
+    }
+    return count;
+}
+
+/*!
+ * \brief first_word is first_word_scalar using the widest vector instructions enabled at compile time.
+ *
+ * The vector loop only finds the first block of words with a non zero predicate, the tail and the matching block are scanned by first_word_scalar.
+ */
+template <ScanPredicate Predicate>
+inline std::size_t first_word(std::uint64_t const* values, std::uint64_t const* messages, std::size_t count) {
+    std::size_t i = 0;
+#if defined(STATUS_OPTIONAL_SIMD_AVX2)
+    __m256i const ones = _mm256_set1_epi64x(-1);
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(values + i));
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(messages + i));
+        __m256i x = Predicate == ScanPredicate::ErrorWord ? _mm256_andnot_si256(v, m) : _mm256_or_si256(_mm256_xor_si256(v, ones), m);
+        if (!_mm256_testz_si256(x, x)) {
+            break;
+        }
+    }
+#elif defined(STATUS_OPTIONAL_SIMD_SSE2)
+    __m128i const ones = _mm_set1_epi32(-1);
+    __m128i const zero = _mm_setzero_si128();
+    for (; i + 2 <= count; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(values + i));
+        __m128i m = _mm_loadu_si128(reinterpret_cast<__m128i const*>(messages + i));
+        __m128i x = Predicate == ScanPredicate::ErrorWord ? _mm_andnot_si128(v, m) : _mm_or_si128(_mm_xor_si128(v, ones), m);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)) != 0xFFFF) {
+            break;
+        }
+    }
+#elif defined(STATUS_OPTIONAL_SIMD_NEON)
+    for (; i + 2 <= count; i += 2) {
+        uint64x2_t v = vld1q_u64(values + i);
+        uint64x2_t m = vld1q_u64(messages + i);
+        uint64x2_t x = Predicate == ScanPredicate::ErrorWord ? vbicq_u64(m, v) : vornq_u64(m, v);
+        if (vmaxvq_u32(vreinterpretq_u32_u64(x)) != 0) {
+            break;
+        }
+    }
+#endif
+    return first_word_scalar<Predicate>(values, messages, count, i);
+}
+
+} // namespace status_optional_detail
+
+/*!
+ * \brief The StatusOptionalBatch class stores a sequence of StatusOptional<T, MsgT> as a structure of arrays.
+ *
+ * The values are stored contiguously, the states are packed in two bitmasks (one bit telling if an element has a value,
+ * one telling if it has a message), and the messages are stored in a sparse side table, sorted by element index.
+ * A batch where most elements are valid is thus almost as dense as a std::vector<T>,
+ * and counting the elements in a given state only reads the bitmasks.
+ * The scans (any_error, all_ok, first_error_index) use AVX2, SSE2 or NEON when enabled at compile time,
+ * defining STATUS_OPTIONAL_NO_SIMD restricts them to the scalar loop.
+ *
+ * The value slot of an element without value holds a default constructed T, so T must be default constructible.
+ * Elements are read through ElementView, which has the observers of StatusOptional and converts to it.
+ *
+ * If a payload copy throws while pushing an element, the element is left in the batch as invalid.
+ */
+template <typename T, typename MsgT = std::string>
+class StatusOptionalBatch {
+
+    static_assert(!std::is_void_v<T>, "StatusOptionalBatch does not support void values, count the states of StatusOptional<void, MsgT> instead");
+    static_assert(std::is_default_constructible_v<T>, "StatusOptionalBatch fills the value slots of elements without value with default constructed values");
+
+public:
+
+    typedef T ValueType;
+    typedef MsgT MessageType;
+    typedef StatusOptional<T, MsgT> ElementType;
+
+    static constexpr std::size_t WordBits = 64;
+
+    /*!
+     * \brief The ElementView class gives read access to an element of a batch, with the observers of StatusOptional.
+     *
+     * An ElementView is invalidated by any modification of the batch.
+     */
+    class ElementView {
+    public:
+
+        explicit operator bool() const {
+            return has_value();
+        }
+
+        bool has_value() const {
+            return _batch->bit(_batch->_valueWords, _index);
+        }
+
+        T const& value() const {
+            if (!has_value()) STATUS_OPTIONAL_UNLIKELY {
+                status_optional_detail::throw_bad_optional_access();
+            }
+            return _batch->_values[_index];
+        }
+
+        template <typename U = T>
+        T value_or(U && defaultValue) const {
+            if (has_value()) {
+                return _batch->_values[_index];
+            }
+            return static_cast<T>(std::forward<U>(defaultValue));
+        }
+
+        bool has_message() const {
+            return _batch->bit(_batch->_messageWords, _index);
+        }
+
+        /*!
+         * \brief message give access to the message, failing as StatusOptional::message does if the element has none.
+         */
+        typename status_message_traits<MsgT>::value_type const& message() const {
+            if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+                status_optional_detail::throw_bad_optional_access();
+            }
+            return status_message_traits<MsgT>::get(_batch->stored_message(_index));
+        }
+
+        /*!
+         * \brief unchecked_message access the message without checking that there is one, which is only asserted when STATUS_OPTIONAL_DEBUG is defined.
+         */
+        typename status_message_traits<MsgT>::value_type const& unchecked_message() const {
+            STATUS_OPTIONAL_ASSERT(has_message());
+            return status_message_traits<MsgT>::get(_batch->stored_message(_index));
+        }
+
+        /*!
+         * \brief is_valid tell if the element holds a value or a message, as StatusOptional::is_valid does (an error is valid).
+         */
+        bool is_valid() const {
+            return has_value() or has_message();
+        }
+
+        bool is_no_error_or_warning() const {
+            return has_value() and !has_message();
+        }
+
+        bool is_warning() const {
+            return has_value() and has_message();
+        }
+
+        bool is_error() const {
+            return !has_value() and has_message();
+        }
+
+        std::size_t index() const {
+            return _index;
+        }
+
+        /*!
+         * \brief Copy the element into a StatusOptional
+         */
+        operator ElementType() const {
+            if (has_value()) {
+                if (has_message()) {
+                    return ElementType::warning(_batch->_values[_index], _batch->stored_message(_index));
+                }
+                return ElementType(_batch->_values[_index]);
+            }
+            if (has_message()) {
+                return ElementType::error(_batch->stored_message(_index));
+            }
+            return ElementType();
+        }
+
+    protected:
+
+        friend class StatusOptionalBatch;
+
+        ElementView(StatusOptionalBatch const* batch, std::size_t index) :
+            _batch(batch),
+            _index(index)
+        {
+
+        }
+
+        StatusOptionalBatch const* _batch;
+        std::size_t _index;
+    };
+
+    /*!
+     * \brief The ValidIterator class iterates over the values of the elements which have one, skipping the others a word of the bitmask at a time.
+     */
+    class ValidIterator {
+    public:
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef T const* pointer;
+        typedef T const& reference;
+
+        ValidIterator() :
+            _batch(nullptr),
+            _word(0),
+            _bits(0)
+        {
+
+        }
+
+        T const& operator*() const {
+            return _batch->_values[index()];
+        }
+
+        T const* operator->() const {
+            return &_batch->_values[index()];
+        }
+
+        /*!
+         * \brief index give the index in the batch of the current element
+         */
+        std::size_t index() const {
+            return _word * WordBits + status_optional_detail::countr_zero64(_bits);
+        }
+
+        ValidIterator& operator++() {
+            _bits &= _bits - 1;
+            skip_empty_words();
+            return *this;
+        }
+
+        ValidIterator operator++(int) {
+            ValidIterator ret = *this;
+            ++(*this);
+            return ret;
+        }
+
+        bool operator==(ValidIterator const& other) const {
+            return _word == other._word and _bits == other._bits;
+        }
+
+        bool operator!=(ValidIterator const& other) const {
+            return !(*this == other);
+        }
+
+    protected:
+
+        friend class StatusOptionalBatch;
+
+        ValidIterator(StatusOptionalBatch const* batch, std::size_t word) :
+            _batch(batch),
+            _word(word),
+            _bits(word < batch->_valueWords.size() ? batch->_valueWords[word] : 0)
+        {
+            skip_empty_words();
+        }
+
+        void skip_empty_words() {
+            while (_bits == 0 and _word < _batch->_valueWords.size()) {
+                _word++;
+                _bits = _word < _batch->_valueWords.size() ? _batch->_valueWords[_word] : 0;
+            }
+        }
+
+        StatusOptionalBatch const* _batch;
+        std::size_t _word;
+        std::uint64_t _bits;
+    };
+
+    /*!
+     * \brief The ValidRange class is the range of the values of a batch returned by valid_values()
+     */
+    class ValidRange {
+    public:
+
+        ValidIterator begin() const {
+            return ValidIterator(_batch, 0);
+        }
+
+        ValidIterator end() const {
+            return ValidIterator(_batch, _batch->_valueWords.size());
+        }
+
+    protected:
+
+        friend class StatusOptionalBatch;
+
+        explicit ValidRange(StatusOptionalBatch const* batch) :
+            _batch(batch)
+        {
+
+        }
+
+        StatusOptionalBatch const* _batch;
+    };
+
+    StatusOptionalBatch() = default;
+
+    std::size_t size() const {
+        return _values.size();
+    }
+
+    bool empty() const {
+        return _values.empty();
+    }
+
+    void reserve(std::size_t capacity) {
+        _values.reserve(capacity);
+        _valueWords.reserve(words_for(capacity));
+        _messageWords.reserve(words_for(capacity));
+    }
+
+    void clear() {
+        _values.clear();
+        _valueWords.clear();
+        _messageWords.clear();
+        _messages.clear();
+    }
+
+    void push_back(ElementType const& element) {
+        push(element);
+    }
+
+    void push_back(ElementType && element) {
+        push(std::move(element));
+    }
+
+    /*!
+     * \brief push_value append a valid element, whose value is constructed from args
+     */
+    template <typename... Args>
+    T& push_value(Args&&... args) {
+        std::size_t index = prepare_words();
+        _values.emplace_back(std::forward<Args>(args)...);
+        set_bit(_valueWords, index);
+        return _values.back();
+    }
+
+    /*!
+     * \brief push_warning append a warning, with value val and message msg
+     */
+    template <typename V, typename M>
+    void push_warning(V && val, M && msg) {
+        std::size_t index = prepare_words();
+        _values.emplace_back(std::forward<V>(val));
+        _messages.emplace_back(index, std::forward<M>(msg));
+        set_bit(_valueWords, index);
+        set_bit(_messageWords, index);
+    }
+
+    /*!
+     * \brief push_error append an error, with message msg
+     */
+    template <typename M>
+    void push_error(M && msg) {
+        std::size_t index = prepare_words();
+        _values.emplace_back();
+        _messages.emplace_back(index, std::forward<M>(msg));
+        set_bit(_messageWords, index);
+    }
+
+    /*!
+     * \brief push_invalid append an invalid element, without value nor message
+     */
+    void push_invalid() {
+        prepare_words();
+        _values.emplace_back();
+    }
+
+    ElementView operator[](std::size_t index) const {
+        return ElementView(this, index);
+    }
+
+    /*!
+     * \brief count_valid count the elements which have a value, with or without warning
+     */
+    std::size_t count_valid() const {
+        std::size_t count = 0;
+        for (std::uint64_t word : _valueWords) {
+            count += status_optional_detail::popcount64(word);
+        }
+        return count;
+    }
+
+    std::size_t count_warnings() const {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < _valueWords.size(); i++) {
+            count += status_optional_detail::popcount64(_valueWords[i] & _messageWords[i]);
+        }
+        return count;
+    }
+
+    std::size_t count_errors() const {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < _valueWords.size(); i++) {
+            count += status_optional_detail::popcount64(~_valueWords[i] & _messageWords[i]);
+        }
+        return count;
+    }
+
+    /*!
+     * \brief any_error tells if at least one element is an error
+     */
+    bool any_error() const {
+        return first_error_index() != size();
+    }
+
+    /*!
+     * \brief all_ok tells if all the elements are valid without message (an empty batch is all ok)
+     */
+    bool all_ok() const {
+        std::size_t fullWords = size() / WordBits;
+        if (status_optional_detail::first_word<status_optional_detail::ScanPredicate::NotOkWord>(value_words(), message_words(), fullWords) != fullWords) {
+            return false;
+        }
+        if (fullWords == word_count()) {
+            return true;
+        }
+        std::uint64_t tail = (std::uint64_t(1) << (size() % WordBits)) - 1;
+        return (status_optional_detail::scan_word<status_optional_detail::ScanPredicate::NotOkWord>(_valueWords.back(), _messageWords.back()) & tail) == 0;
+    }
+
+    /*!
+     * \brief first_error_index give the index of the first error, or size() if there is none
+     */
+    std::size_t first_error_index() const {
+        std::size_t w = status_optional_detail::first_word<status_optional_detail::ScanPredicate::ErrorWord>(value_words(), message_words(), word_count());
+        if (w == word_count()) {
+            return size();
+        }
+        std::uint64_t bits = status_optional_detail::scan_word<status_optional_detail::ScanPredicate::ErrorWord>(_valueWords[w], _messageWords[w]);
+        return w * WordBits + status_optional_detail::countr_zero64(bits);
+    }
+
+    /*!
+     * \brief The Partition struct holds the indices of the elements of a batch, grouped by state, in increasing order.
+     */
+    struct Partition {
+        std::vector<std::size_t> ok;
+        std::vector<std::size_t> warnings;
+        std::vector<std::size_t> errors;
+        std::vector<std::size_t> invalid;
+    };
+
+    /*!
+     * \brief partition_by_state group the indices of the elements by state.
+     *
+     * The groups are sized by counting the bits of the state masks first, so each vector allocates once.
+     */
+    Partition partition_by_state() const {
+        Partition ret;
+        std::size_t counts[4] = {0, 0, 0, 0};
+        for_each_state_mask([&counts] (std::size_t, std::uint64_t const (&masks)[4]) {
+            for (int s = 0; s < 4; s++) {
+                counts[s] += status_optional_detail::popcount64(masks[s]);
+            }
+        });
+        std::vector<std::size_t>* groups[4] = {&ret.ok, &ret.warnings, &ret.errors, &ret.invalid};
+        for (int s = 0; s < 4; s++) {
+            groups[s]->reserve(counts[s]);
+        }
+        for_each_state_mask([&groups] (std::size_t w, std::uint64_t const (&masks)[4]) {
+            for (int s = 0; s < 4; s++) {
+                std::uint64_t bits = masks[s];
+                while (bits != 0) {
+                    groups[s]->push_back(w * WordBits + status_optional_detail::countr_zero64(bits));
+                    bits &= bits - 1;
+                }
+            }
+        });
+        return ret;
+    }
+
+    /*!
+     * \brief valid_values give a range over the values of the elements which have one, in index order
+     */
+    ValidRange valid_values() const {
+        return ValidRange(this);
+    }
+
+    /*!
+     * \brief for_each_valid call f(index, value) for each element which has a value, in index order
+     */
+    template <typename F>
+    void for_each_valid(F && f) const {
+        for (std::size_t w = 0; w < _valueWords.size(); w++) {
+            std::uint64_t bits = _valueWords[w];
+            while (bits != 0) {
+                std::size_t index = w * WordBits + status_optional_detail::countr_zero64(bits);
+                f(index, _values[index]);
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    /*!
+     * \brief value_data give the contiguous array of the size() value slots, including the placeholders of the elements without value
+     */
+    T const* value_data() const {
+        return _values.data();
+    }
+
+    /*!
+     * \brief word_count give the number of 64 bits words of each state bitmask, bit i%64 of word i/64 is the state of element i
+     */
+    std::size_t word_count() const {
+        return words_for(size());
+    }
+
+    std::uint64_t const* value_words() const {
+        return _valueWords.data();
+    }
+
+    std::uint64_t const* message_words() const {
+        return _messageWords.data();
+    }
+
+protected:
+
+    static constexpr std::size_t words_for(std::size_t count) {
+        return (count + WordBits - 1) / WordBits;
+    }
+
+    static bool bit(std::vector<std::uint64_t> const& words, std::size_t index) {
+        return (words[index / WordBits] >> (index % WordBits)) & 1;
+    }
+
+    static void set_bit(std::vector<std::uint64_t> & words, std::size_t index) {
+        words[index / WordBits] |= std::uint64_t(1) << (index % WordBits);
+    }
+
+    /*!
+     * \brief prepare_words make sure the bitmasks have a word for the next element, and return its index.
+     */
+    std::size_t prepare_words() {
+        std::size_t index = _values.size();
+        if (_valueWords.size() <= index / WordBits) {
+            _valueWords.push_back(0);
+        }
+        if (_messageWords.size() <= index / WordBits) {
+            _messageWords.push_back(0);
+        }
+        return index;
+    }
+
+    /*!
+     * \brief for_each_state_mask call f(w, masks) for each bitmask word w, masks holding the ok, warning, error and invalid bits of word w.
+     */
+    template <typename F>
+    void for_each_state_mask(F && f) const {
+        for (std::size_t w = 0; w < _valueWords.size(); w++) {
+            std::uint64_t v = _valueWords[w];
+            std::uint64_t m = _messageWords[w];
+            std::size_t remaining = size() - w * WordBits;
+            std::uint64_t live = remaining >= WordBits ? ~std::uint64_t(0) : (std::uint64_t(1) << remaining) - 1;
+            std::uint64_t const masks[4] = {v & ~m, v & m, ~v & m, ~v & ~m & live};
+            f(w, masks);
+        }
+    }
+
+    template <typename Element>
+    void push(Element && element) {
+        using Access = status_optional_detail::Access;
+
+        std::size_t index = prepare_words();
+        if (element.has_value()) {
+            _values.push_back(Access::stored_value(std::forward<Element>(element)));
+        } else {
+            _values.emplace_back();
+        }
+        if (element.has_message()) {
+            _messages.emplace_back(index, Access::stored_message(std::forward<Element>(element)));
+            set_bit(_messageWords, index);
+        }
+        if (element.has_value()) {
+            set_bit(_valueWords, index);
+        }
+    }
+
+    MsgT const& stored_message(std::size_t index) const {
+        auto it = std::lower_bound(_messages.begin(), _messages.end(), index,
+                                   [] (std::pair<std::size_t, MsgT> const& entry, std::size_t i) { return entry.first < i; });
+        return it->second;
+    }
+
+    std::vector<T> _values;
+    std::vector<std::uint64_t> _valueWords;
+    std::vector<std::uint64_t> _messageWords;
+    std::vector<std::pair<std::size_t, MsgT>> _messages;
+};
+
+#endif // STATUS_OPTIONAL_BATCH_H
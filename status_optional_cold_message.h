@@ -0,0 +1,102 @@
+#ifndef STATUS_OPTIONAL_COLD_MESSAGE_H
+#define STATUS_OPTIONAL_COLD_MESSAGE_H
+
+#include <type_traits>
+#include <utility>
+
+#include "./status_optional.h"
+
+/*!
+ * \brief The ColdMessage class is a message type storing its message out of line, behind a single owning pointer.
+ *
+ * Large message types make every StatusOptional as large as the message, even when it only holds a value.
+ * StatusOptional<T, ColdMessage<MsgT>> only reserves a pointer for the message,
+ * and the message is allocated when a warning or an error is built.
+ *
+ * status_message_traits is specialized so that StatusOptional<T, ColdMessage<MsgT>>::message() returns the MsgT.
+ * A moved from ColdMessage does not own a message anymore, and must not be read before being assigned to.
+ */
+template <typename MsgT>
+class ColdMessage {
+public:
+
+    typedef MsgT MessageType;
+
+    template <typename U,
+              std::enable_if_t<!std::is_same_v<std::decay_t<U>, ColdMessage> and
+                               std::is_constructible_v<MsgT, U&&>, bool> = true>
+    ColdMessage(U && msg) :
+        _msg(new MsgT(std::forward<U>(msg)))
+    {
+
+    }
+
+    /*!
+     * \brief Construct a ColdMessage owning a message built in place from args
+     */
+    template <typename... Args>
+    explicit ColdMessage(std::in_place_t, Args&&... args) :
+        _msg(new MsgT(std::forward<Args>(args)...))
+    {
+
+    }
+
+    ColdMessage(ColdMessage const& other) :
+        _msg(other._msg == nullptr ? nullptr : new MsgT(*other._msg))
+    {
+
+    }
+
+    ColdMessage(ColdMessage && other) noexcept :
+        _msg(other._msg)
+    {
+        other._msg = nullptr;
+    }
+
+    ~ColdMessage() {
+        delete _msg;
+    }
+
+    ColdMessage& operator=(ColdMessage const& other) {
+        if (this != &other) {
+            if (_msg != nullptr and other._msg != nullptr) {
+                *_msg = *other._msg;
+            } else {
+                ColdMessage copy(other);
+                std::swap(_msg, copy._msg);
+            }
+        }
+        return *this;
+    }
+
+    ColdMessage& operator=(ColdMessage && other) noexcept {
+        std::swap(_msg, other._msg);
+        return *this;
+    }
+
+    MsgT& get() {
+        return *_msg;
+    }
+
+    MsgT const& get() const {
+        return *_msg;
+    }
+
+protected:
+    MsgT* _msg;
+};
+
+template <typename MsgT>
+struct status_message_traits<ColdMessage<MsgT>> {
+    typedef MsgT value_type;
+
+    static MsgT& get(ColdMessage<MsgT> & msg) noexcept {
+        return msg.get();
+    }
+
+    static MsgT const& get(ColdMessage<MsgT> const& msg) noexcept {
+        return msg.get();
+    }
+};
+
+#endif // STATUS_OPTIONAL_COLD_MESSAGE_H
@@ -0,0 +1,2758 @@
+#ifndef STATUS_OPTIONAL_CORE_H
+#define STATUS_OPTIONAL_CORE_H
+
+#include <optional>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*!
+ * STATUS_OPTIONAL_COLD marks a function as rarely called, so it is kept out of line and the calls to it are predicted not taken.
+ * STATUS_OPTIONAL_UNLIKELY marks a branch as rarely taken, it expands to [[unlikely]] from C++20 and to nothing before.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define STATUS_OPTIONAL_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define STATUS_OPTIONAL_COLD __declspec(noinline)
+#else
+#define STATUS_OPTIONAL_COLD
+#endif
+
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#define STATUS_OPTIONAL_UNLIKELY [[unlikely]]
+#else
+#define STATUS_OPTIONAL_UNLIKELY
+#endif
+
+/*!
+ * STATUS_OPTIONAL_HAS_EXCEPTIONS is 0 when exceptions are disabled (e.g. -fno-exceptions),
+ * the checked accessors then abort instead of throwing std::bad_optional_access.
+ */
+#ifndef STATUS_OPTIONAL_HAS_EXCEPTIONS
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define STATUS_OPTIONAL_HAS_EXCEPTIONS 1
+#else
+#define STATUS_OPTIONAL_HAS_EXCEPTIONS 0
+#endif
+#endif
+
+/*!
+ * STATUS_OPTIONAL_DEBUG enables the assertions of the unchecked accessors (operator*, operator->, unchecked_value and unchecked_message),
+ * which abort with a message when the payload they access is not there. Without it, the accessors do not check anything.
+ */
+#if defined(STATUS_OPTIONAL_DEBUG)
+#define STATUS_OPTIONAL_ASSERT(cond) ((cond) ? (void) 0 : ::status_optional_detail::assertion_failed(#cond, __FILE__, __LINE__))
+#else
+#define STATUS_OPTIONAL_ASSERT(cond) ((void) 0)
+#endif
+
+/*!
+ * STATUS_OPTIONAL_INSTRUMENTATION makes the warning and error factories report their call site, see status_optional_instrumentation.h.
+ */
+#if defined(STATUS_OPTIONAL_INSTRUMENTATION)
+#include "./status_optional_instrumentation.h"
+#define STATUS_OPTIONAL_SITE_PARAM , StatusOptionalSite site = StatusOptionalSite::current()
+#define STATUS_OPTIONAL_RECORD(site, event) status_optional_detail::record_site(site, StatusOptionalEvent::event)
+#else
+#define STATUS_OPTIONAL_SITE_PARAM
+#define STATUS_OPTIONAL_RECORD(site, event) ((void) 0)
+#endif
+
+/*!
+ * The message type has no default in the core header, which does not include <string>:
+ * status_optional.h includes it and makes std::string the default message type.
+ */
+template <typename T, typename MsgT>
+class StatusOptional;
+
+/*!
+ * \brief status_message_traits is the customization point for message types which are not read as they are stored.
+ *
+ * value_type is the type returned by StatusOptional::message(), and get gives access to it from the stored message.
+ * By default the stored message is returned as is.
+ */
+template <typename MsgT>
+struct status_message_traits {
+    typedef MsgT value_type;
+
+    static constexpr MsgT& get(MsgT & msg) noexcept {
+        return msg;
+    }
+
+    static constexpr MsgT const& get(MsgT const& msg) noexcept {
+        return msg;
+    }
+};
+
+namespace status_optional_detail {
+
+/*!
+ * \brief is_string_like tells if MsgT is a string class (std::basic_string or a class with the same interface), detected
+ * from its traits_type, push_back and append members so that the core header does not need to include <string>.
+ */
+template <typename MsgT, typename = void>
+struct is_string_like : std::false_type {};
+
+template <typename MsgT>
+struct is_string_like<MsgT, std::void_t<typename MsgT::traits_type,
+                                        decltype(std::declval<MsgT&>().push_back(std::declval<typename MsgT::value_type>())),
+                                        decltype(std::declval<MsgT&>().append(std::declval<MsgT const&>()))>> : std::true_type {};
+
+} // namespace status_optional_detail
+
+/*!
+ * \brief status_message_merge is the customization point used to merge the warnings of several results into one message.
+ *
+ * merge(into, from) appends from to into. By default strings (see is_string_like) are joined with a new line,
+ * and for other message types the first warning is kept.
+ *
+ * A specialization can also declare `static constexpr bool accumulate = true`, so that and_then merges the warning of
+ * its input with the warning of the result of its callback, rather than keeping only the newer one.
+ */
+template <typename MsgT>
+struct status_message_merge {
+    static void merge(MsgT & into, MsgT && from) {
+        if constexpr (status_optional_detail::is_string_like<MsgT>::value) {
+            into.push_back(typename MsgT::value_type('\n'));
+            into.append(from);
+        } else {
+            (void) into;
+            (void) from;
+        }
+    }
+};
+
+/*!
+ * \brief status_message_reuse is the customization point letting a StatusOptional keep the buffer of the messages it drops.
+ *
+ * When keep_capacity is true, a StatusOptional dropping its message (reset(), emplace_value(), operator= with a value)
+ * calls clear(msg) instead of destroying it, and the next message set in place is assigned to the retained one,
+ * so a std::string keeps its capacity. By default messages are destroyed when dropped.
+ * status_optional_reusable_message.h provides ReusableMessage, which enables it.
+ */
+template <typename MsgT>
+struct status_message_reuse {
+    static constexpr bool keep_capacity = false;
+};
+
+/*!
+ * \brief status_optional_niche is the customization point letting a type declare a bit pattern it never uses as a value.
+ *
+ * When both the value type and the message type of a StatusOptional<T, MsgT> have a niche,
+ * the StatusOptional stores no discriminant: a payload equal to its niche is absent.
+ * A specialization needs available set to true, a static empty() returning the niche
+ * and a static is_empty(v) telling if v is the niche. Storing the niche as a value or message is a logic error.
+ */
+template <typename T>
+struct status_optional_niche {
+    static constexpr bool available = false;
+};
+
+/*!
+ * \brief status_optional_sentinel_niche implements status_optional_niche for a type with an unused constant,
+ * such as nullptr for pointers which can never be null or an invalid index.
+ *
+ * \code
+ * template <> struct status_optional_niche<Entry*> : status_optional_sentinel_niche<Entry*, nullptr> {};
+ * \endcode
+ */
+template <typename T, T Sentinel>
+struct status_optional_sentinel_niche {
+    static constexpr bool available = true;
+
+    static constexpr T empty() noexcept {
+        return Sentinel;
+    }
+
+    static constexpr bool is_empty(T const& val) noexcept {
+        return val == Sentinel;
+    }
+};
+
+/*!
+ * \brief status_optional_nan_niche implements status_optional_niche for float and double, using a quiet NaN with a distinctive payload.
+ *
+ * Other NaN values can still be stored as values.
+ */
+template <typename F>
+struct status_optional_nan_niche {
+    static_assert(std::is_same_v<F, double> or std::is_same_v<F, float>, "status_optional_nan_niche is only implemented for float and double");
+    static_assert(std::numeric_limits<F>::is_iec559, "status_optional_nan_niche requires IEEE 754 floating point types");
+
+    typedef std::conditional_t<std::is_same_v<F, double>, std::uint64_t, std::uint32_t> Bits;
+
+    static constexpr Bits pattern = std::is_same_v<F, double> ? Bits(0x7ff8'5354'4f50'5400ull) : Bits(0x7fd3'5354u);
+
+    static constexpr bool available = true;
+
+    static F empty() noexcept {
+        F ret;
+        std::memcpy(&ret, &pattern, sizeof(F));
+        return ret;
+    }
+
+    static bool is_empty(F val) noexcept {
+        Bits bits;
+        std::memcpy(&bits, &val, sizeof(F));
+        return bits == pattern;
+    }
+};
+
+/*!
+ * \brief StatusOptionalState is the state of a StatusOptional, returned by StatusOptional::state().
+ *
+ * Its values are the bits of the discriminant, so reading it is a single load (or two niche checks).
+ * For StatusOptional<void, MsgT>, Ok is a valid status without message.
+ */
+enum class StatusOptionalState : unsigned char {
+    Invalid = 0,
+    Ok = 1,
+    Error = 2,
+    Warning = 3
+};
+
+namespace status_optional_detail {
+
+/*!
+ * \brief Bits of the single discriminant byte stored by StatusOptional.
+ *
+ * ValueFlag is set when a value is held (for StatusOptional<void, MsgT>, when the status is valid),
+ * MessageFlag is set when a message is held. A warning has both flags set, an error only MessageFlag.
+ * RetainedFlag is only set for the message types keeping their capacity (see status_message_reuse),
+ * when the message has been dropped but is still alive. flags() never reports it.
+ */
+enum StateFlags : unsigned char {
+    NoFlag = 0,
+    ValueFlag = 1,
+    MessageFlag = 2,
+    RetainedFlag = 4
+};
+
+static_assert(static_cast<unsigned char>(StatusOptionalState::Ok) == ValueFlag and
+              static_cast<unsigned char>(StatusOptionalState::Error) == MessageFlag and
+              static_cast<unsigned char>(StatusOptionalState::Warning) == (ValueFlag | MessageFlag),
+              "StatusOptionalState must match the bits of the discriminant");
+
+/*!
+ * \brief throw_bad_optional_access is the out of line failure path of the checked accessors.
+ */
+[[noreturn]] STATUS_OPTIONAL_COLD inline void throw_bad_optional_access() {
+#if STATUS_OPTIONAL_HAS_EXCEPTIONS
+    throw std::bad_optional_access();
+#else
+    std::fputs("StatusOptional: bad optional access\n", stderr);
+    std::abort();
+#endif
+}
+
+/*!
+ * \brief rethrow_current_exception rethrow the exception being handled, or abort when exceptions are disabled (where none can be handled).
+ */
+[[noreturn]] STATUS_OPTIONAL_COLD inline void rethrow_current_exception() {
+#if STATUS_OPTIONAL_HAS_EXCEPTIONS
+    throw;
+#else
+    std::fputs("StatusOptional: unhandled exception\n", stderr);
+    std::abort();
+#endif
+}
+
+/*!
+ * \brief usage_error abort with a message, for the misuses which cannot be reported otherwise.
+ */
+[[noreturn]] STATUS_OPTIONAL_COLD inline void usage_error(char const* what) {
+    std::fprintf(stderr, "StatusOptional: %s\n", what);
+    std::abort();
+}
+
+/*!
+ * \brief assertion_failed is called by STATUS_OPTIONAL_ASSERT when STATUS_OPTIONAL_DEBUG is defined.
+ */
+[[noreturn]] STATUS_OPTIONAL_COLD inline void assertion_failed(char const* expr, char const* file, int line) {
+    std::fprintf(stderr, "%s:%d: StatusOptional assertion failed: %s\n", file, line, expr);
+    std::abort();
+}
+
+/*!
+ * \brief Tags selecting the in place constructors of the storage which build a message (error) or a value and a message (warning).
+ */
+struct InPlaceError {};
+struct InPlaceWarning {};
+
+/*!
+ * \brief UsesAllocator builds a T using uses-allocator construction, it is defined by status_optional_allocator.h,
+ * so that the core header does not include <memory> (<tuple> declares std::allocator_arg_t, used by the constructors of std::tuple).
+ */
+template <typename T, typename Alloc>
+struct UsesAllocator;
+
+/*!
+ * \brief make_with_allocator build a T from args using uses-allocator construction (as std::make_obj_using_allocator).
+ *
+ * The allocator aware constructors and factories need status_optional_allocator.h, which status_optional.h includes.
+ */
+template <typename T, typename Alloc, typename... Args>
+constexpr T make_with_allocator(Alloc const& alloc, Args&&... args) {
+    return UsesAllocator<T, Alloc>::make(alloc, std::forward<Args>(args)...);
+}
+
+/*!
+ * \brief address_of is std::addressof, which is declared in <memory>.
+ */
+template <typename T>
+constexpr T* address_of(T & val) noexcept {
+    return __builtin_addressof(val);
+}
+
+/*!
+ * \brief both_v tells if a type trait holds for the value type (ignored when it is void) and the message type.
+ */
+template <template <typename> class Trait, typename T, typename MsgT>
+constexpr bool both_v = (std::is_void_v<T> or Trait<T>::value) and Trait<MsgT>::value;
+
+/*!
+ * \brief The Slot union is raw storage for a payload, which is constructed and destroyed by its owner.
+ */
+template <typename T, bool = std::is_trivially_destructible_v<T>>
+union Slot {
+    constexpr Slot() :
+        _empty()
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit Slot(std::in_place_t, Args&&... args) :
+        _payload(std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr Slot(std::allocator_arg_t, Alloc const& alloc, Args&&... args) :
+        _payload(make_with_allocator<T>(alloc, std::forward<Args>(args)...))
+    {
+
+    }
+
+    char _empty;
+    T _payload;
+};
+
+template <typename T>
+union Slot<T, false> {
+    constexpr Slot() :
+        _empty()
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit Slot(std::in_place_t, Args&&... args) :
+        _payload(std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr Slot(std::allocator_arg_t, Alloc const& alloc, Args&&... args) :
+        _payload(make_with_allocator<T>(alloc, std::forward<Args>(args)...))
+    {
+
+    }
+
+    ~Slot() {
+
+    }
+
+    char _empty;
+    T _payload;
+};
+
+/*!
+ * \brief The Storage struct holds the payload slots and the discriminant of a StatusOptional.
+ */
+template <typename T, typename MsgT>
+struct Storage {
+    constexpr Storage() :
+        _value(),
+        _message(),
+        _state(NoFlag)
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit Storage(std::in_place_t, Args&&... args) :
+        _value(std::in_place, std::forward<Args>(args)...),
+        _message(),
+        _state(ValueFlag)
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit Storage(InPlaceError, Args&&... args) :
+        _value(),
+        _message(std::in_place, std::forward<Args>(args)...),
+        _state(MessageFlag)
+    {
+
+    }
+
+    template <typename V, typename M>
+    constexpr Storage(InPlaceWarning, V && val, M && msg) :
+        _value(std::in_place, std::forward<V>(val)),
+        _message(std::in_place, std::forward<M>(msg)),
+        _state(ValueFlag | MessageFlag)
+    {
+
+    }
+
+    template <typename... VArgs, typename... MArgs>
+    constexpr Storage(std::piecewise_construct_t, std::tuple<VArgs...> valArgs, std::tuple<MArgs...> msgArgs) :
+        Storage(valArgs, msgArgs, std::index_sequence_for<VArgs...>(), std::index_sequence_for<MArgs...>())
+    {
+
+    }
+
+    template <typename VTuple, typename MTuple, std::size_t... VIs, std::size_t... MIs>
+    constexpr Storage(VTuple & valArgs, MTuple & msgArgs, std::index_sequence<VIs...>, std::index_sequence<MIs...>) :
+        _value(std::in_place, std::get<VIs>(std::move(valArgs))...),
+        _message(std::in_place, std::get<MIs>(std::move(msgArgs))...),
+        _state(ValueFlag | MessageFlag)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr Storage(std::allocator_arg_t, Alloc const& alloc, std::in_place_t, Args&&... args) :
+        _value(std::allocator_arg, alloc, std::forward<Args>(args)...),
+        _message(),
+        _state(ValueFlag)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr Storage(std::allocator_arg_t, Alloc const& alloc, InPlaceError, Args&&... args) :
+        _value(),
+        _message(std::allocator_arg, alloc, std::forward<Args>(args)...),
+        _state(MessageFlag)
+    {
+
+    }
+
+    template <typename Alloc, typename V, typename... Args>
+    constexpr Storage(std::allocator_arg_t, Alloc const& alloc, InPlaceWarning, V && val, Args&&... args) :
+        _value(std::allocator_arg, alloc, std::forward<V>(val)),
+        _message(std::allocator_arg, alloc, std::forward<Args>(args)...),
+        _state(ValueFlag | MessageFlag)
+    {
+
+    }
+
+    constexpr unsigned char flags() const {
+        if constexpr (status_message_reuse<MsgT>::keep_capacity) {
+            return _state & (ValueFlag | MessageFlag);
+        } else {
+            return _state;
+        }
+    }
+
+    Slot<T> _value;
+    Slot<MsgT> _message;
+    unsigned char _state;
+};
+
+template <typename MsgT>
+struct Storage<void, MsgT> {
+    constexpr Storage() :
+        _message(),
+        _state(ValueFlag)
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit Storage(InPlaceError, Args&&... args) :
+        _message(std::in_place, std::forward<Args>(args)...),
+        _state(MessageFlag)
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit Storage(InPlaceWarning, Args&&... args) :
+        _message(std::in_place, std::forward<Args>(args)...),
+        _state(ValueFlag | MessageFlag)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr Storage(std::allocator_arg_t, Alloc const& alloc, InPlaceError, Args&&... args) :
+        _message(std::allocator_arg, alloc, std::forward<Args>(args)...),
+        _state(MessageFlag)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr Storage(std::allocator_arg_t, Alloc const& alloc, InPlaceWarning, Args&&... args) :
+        _message(std::allocator_arg, alloc, std::forward<Args>(args)...),
+        _state(ValueFlag | MessageFlag)
+    {
+
+    }
+
+    constexpr unsigned char flags() const {
+        if constexpr (status_message_reuse<MsgT>::keep_capacity) {
+            return _state & (ValueFlag | MessageFlag);
+        } else {
+            return _state;
+        }
+    }
+
+    Slot<MsgT> _message;
+    unsigned char _state;
+};
+
+/*!
+ * \brief The DestructibleStorage struct destroys the live payloads, and is trivially destructible when both payloads are.
+ */
+template <typename T, typename MsgT, bool = both_v<std::is_trivially_destructible, T, MsgT>>
+struct DestructibleStorage : Storage<T, MsgT> {
+    using Storage<T, MsgT>::Storage;
+};
+
+template <typename T, typename MsgT>
+struct DestructibleStorage<T, MsgT, false> : Storage<T, MsgT> {
+    using Storage<T, MsgT>::Storage;
+
+    DestructibleStorage() = default;
+    DestructibleStorage(DestructibleStorage const&) = default;
+    DestructibleStorage(DestructibleStorage &&) = default;
+    DestructibleStorage& operator=(DestructibleStorage const&) = default;
+    DestructibleStorage& operator=(DestructibleStorage &&) = default;
+
+    ~DestructibleStorage() {
+        if constexpr (!std::is_void_v<T>) {
+            if (this->flags() & ValueFlag) {
+                this->_value._payload.~T();
+            }
+        }
+        constexpr unsigned char alive = status_message_reuse<MsgT>::keep_capacity ? (MessageFlag | RetainedFlag) : MessageFlag;
+        if (this->_state & alive) {
+            this->_message._payload.~MsgT();
+        }
+    }
+};
+
+/*!
+ * \brief The NicheSlot struct holds a payload which is always alive, and holds its niche when absent.
+ */
+template <typename T>
+struct NicheSlot {
+    constexpr NicheSlot() :
+        _payload(status_optional_niche<T>::empty())
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit NicheSlot(std::in_place_t, Args&&... args) :
+        _payload(std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr NicheSlot(std::allocator_arg_t, Alloc const& alloc, Args&&... args) :
+        _payload(make_with_allocator<T>(alloc, std::forward<Args>(args)...))
+    {
+
+    }
+
+    T _payload;
+};
+
+/*!
+ * \brief The NicheStorage struct holds the payloads of a StatusOptional whose value and message types have a niche.
+ *
+ * Both payloads are always alive, the absent ones hold their niche.
+ */
+template <typename T, typename MsgT>
+struct NicheStorage {
+    constexpr NicheStorage() :
+        _value(),
+        _message()
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit NicheStorage(std::in_place_t, Args&&... args) :
+        _value(std::in_place, std::forward<Args>(args)...),
+        _message()
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit NicheStorage(InPlaceError, Args&&... args) :
+        _value(),
+        _message(std::in_place, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename V, typename M>
+    constexpr NicheStorage(InPlaceWarning, V && val, M && msg) :
+        _value(std::in_place, std::forward<V>(val)),
+        _message(std::in_place, std::forward<M>(msg))
+    {
+
+    }
+
+    template <typename... VArgs, typename... MArgs>
+    constexpr NicheStorage(std::piecewise_construct_t, std::tuple<VArgs...> valArgs, std::tuple<MArgs...> msgArgs) :
+        NicheStorage(valArgs, msgArgs, std::index_sequence_for<VArgs...>(), std::index_sequence_for<MArgs...>())
+    {
+
+    }
+
+    template <typename VTuple, typename MTuple, std::size_t... VIs, std::size_t... MIs>
+    constexpr NicheStorage(VTuple & valArgs, MTuple & msgArgs, std::index_sequence<VIs...>, std::index_sequence<MIs...>) :
+        _value(std::in_place, std::get<VIs>(std::move(valArgs))...),
+        _message(std::in_place, std::get<MIs>(std::move(msgArgs))...)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr NicheStorage(std::allocator_arg_t, Alloc const& alloc, std::in_place_t, Args&&... args) :
+        _value(std::allocator_arg, alloc, std::forward<Args>(args)...),
+        _message()
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr NicheStorage(std::allocator_arg_t, Alloc const& alloc, InPlaceError, Args&&... args) :
+        _value(),
+        _message(std::allocator_arg, alloc, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename Alloc, typename V, typename... Args>
+    constexpr NicheStorage(std::allocator_arg_t, Alloc const& alloc, InPlaceWarning, V && val, Args&&... args) :
+        _value(std::allocator_arg, alloc, std::forward<V>(val)),
+        _message(std::allocator_arg, alloc, std::forward<Args>(args)...)
+    {
+
+    }
+
+    constexpr unsigned char flags() const {
+        return (status_optional_niche<T>::is_empty(_value._payload) ? NoFlag : ValueFlag) |
+               (status_optional_niche<MsgT>::is_empty(_message._payload) ? NoFlag : MessageFlag);
+    }
+
+    NicheSlot<T> _value;
+    NicheSlot<MsgT> _message;
+};
+
+/*!
+ * \brief uses_niche_v tells if a StatusOptional<T, MsgT> stores its state in the niches of its payloads instead of a discriminant.
+ */
+template <typename T, typename MsgT>
+constexpr bool uses_niche_v = !std::is_void_v<T> and status_optional_niche<T>::available and status_optional_niche<MsgT>::available;
+
+template <typename T, typename MsgT>
+using StorageFor = std::conditional_t<uses_niche_v<T, MsgT>, NicheStorage<T, MsgT>, DestructibleStorage<T, MsgT>>;
+
+/*!
+ * \brief The StorageOps struct implements the state transitions shared by both StatusOptional variants.
+ */
+template <typename T, typename MsgT>
+struct StorageOps : StorageFor<T, MsgT> {
+    typedef StorageFor<T, MsgT> StorageBase;
+    using StorageBase::StorageBase;
+
+    static constexpr bool Niche = uses_niche_v<T, MsgT>;
+
+    /*!
+     * \brief Retain tells if a dropped message is kept alive (flagged RetainedFlag) to reuse its buffer.
+     */
+    static constexpr bool Retain = status_message_reuse<MsgT>::keep_capacity and !Niche;
+
+    constexpr bool has_value() const {
+        return this->flags() & ValueFlag;
+    }
+
+    constexpr bool has_message() const {
+        return this->flags() & MessageFlag;
+    }
+
+    template <typename... Args>
+    void construct_value(Args&&... args) {
+        if constexpr (Niche) {
+            this->_value._payload = T(std::forward<Args>(args)...);
+        } else {
+            ::new (static_cast<void*>(&this->_value._payload)) T(std::forward<Args>(args)...);
+            this->_state |= ValueFlag;
+        }
+    }
+
+    template <typename Alloc, typename... Args>
+    void construct_value_with_allocator(Alloc const& alloc, Args&&... args) {
+        if constexpr (Niche) {
+            this->_value._payload = make_with_allocator<T>(alloc, std::forward<Args>(args)...);
+        } else {
+            ::new (static_cast<void*>(&this->_value._payload)) T(make_with_allocator<T>(alloc, std::forward<Args>(args)...));
+            this->_state |= ValueFlag;
+        }
+    }
+
+    template <typename V>
+    void assign_value(V && val) {
+        if (has_value()) {
+            this->_value._payload = std::forward<V>(val);
+        } else {
+            construct_value(std::forward<V>(val));
+        }
+    }
+
+    void destroy_value() {
+        if (!has_value()) {
+            return;
+        }
+        if constexpr (Niche) {
+            this->_value._payload = status_optional_niche<T>::empty();
+        } else {
+            this->_value._payload.~T();
+            this->_state &= ~ValueFlag;
+        }
+    }
+
+    template <typename... Args>
+    void construct_message(Args&&... args) {
+        if constexpr (Niche) {
+            this->_message._payload = MsgT(std::forward<Args>(args)...);
+        } else {
+            if constexpr (Retain) {
+                if (this->_state & RetainedFlag) {
+                    if constexpr (sizeof...(Args) == 1) {
+                        this->_message._payload = (std::forward<Args>(args), ...);
+                    } else {
+                        this->_message._payload = MsgT(std::forward<Args>(args)...);
+                    }
+                    this->_state = (this->_state & ~RetainedFlag) | MessageFlag;
+                    return;
+                }
+            }
+            ::new (static_cast<void*>(&this->_message._payload)) MsgT(std::forward<Args>(args)...);
+            this->_state |= MessageFlag;
+        }
+    }
+
+    template <typename Alloc, typename... Args>
+    void construct_message_with_allocator(Alloc const& alloc, Args&&... args) {
+        if constexpr (Niche) {
+            this->_message._payload = make_with_allocator<MsgT>(alloc, std::forward<Args>(args)...);
+        } else {
+            if constexpr (Retain) {
+                if (this->_state & RetainedFlag) {
+                    this->_message._payload.~MsgT();
+                    this->_state &= ~RetainedFlag;
+                }
+            }
+            ::new (static_cast<void*>(&this->_message._payload)) MsgT(make_with_allocator<MsgT>(alloc, std::forward<Args>(args)...));
+            this->_state |= MessageFlag;
+        }
+    }
+
+    template <typename M>
+    void assign_message(M && msg) {
+        if (has_message()) {
+            this->_message._payload = std::forward<M>(msg);
+        } else {
+            construct_message(std::forward<M>(msg));
+        }
+    }
+
+    void destroy_message() {
+        if (!has_message()) {
+            return;
+        }
+        if constexpr (Niche) {
+            this->_message._payload = status_optional_niche<MsgT>::empty();
+        } else if constexpr (Retain) {
+            status_message_reuse<MsgT>::clear(this->_message._payload);
+            this->_state = (this->_state & ~MessageFlag) | RetainedFlag;
+        } else {
+            this->_message._payload.~MsgT();
+            this->_state &= ~MessageFlag;
+        }
+    }
+
+    /*!
+     * \brief construct_from copy or move the state of other, *this must not hold any payload.
+     */
+    template <typename Other>
+    void construct_from(Other && other) {
+        if constexpr (std::is_void_v<T>) {
+            this->_state = other.flags() & ValueFlag;
+        } else if (other.has_value()) {
+            construct_value(std::forward<Other>(other)._value._payload);
+        }
+        if (other.has_message()) {
+            construct_message(std::forward<Other>(other)._message._payload);
+        }
+    }
+
+    /*!
+     * \brief construct_from_with_allocator copy or move the state of other using uses-allocator construction, *this must not hold any payload.
+     */
+    template <typename Alloc, typename Other>
+    void construct_from_with_allocator(Alloc const& alloc, Other && other) {
+        if constexpr (std::is_void_v<T>) {
+            this->_state = other.flags() & ValueFlag;
+        } else if (other.has_value()) {
+            construct_value_with_allocator(alloc, std::forward<Other>(other)._value._payload);
+        }
+        if (other.has_message()) {
+            construct_message_with_allocator(alloc, std::forward<Other>(other)._message._payload);
+        }
+    }
+
+    template <typename Other>
+    void assign_from(Other && other) {
+        if constexpr (std::is_void_v<T>) {
+            this->_state = (this->_state & ~ValueFlag) | (other.flags() & ValueFlag);
+        } else if (other.has_value()) {
+            assign_value(std::forward<Other>(other)._value._payload);
+        } else {
+            destroy_value();
+        }
+        if (other.has_message()) {
+            assign_message(std::forward<Other>(other)._message._payload);
+        } else {
+            destroy_message();
+        }
+    }
+};
+
+/*!
+ * \brief How a layer provides its special member: left trivial, provided by the layer, or deleted.
+ */
+enum class SpecialMember {
+    Trivial,
+    Provided,
+    Deleted
+};
+
+template <bool trivial, bool enabled>
+constexpr SpecialMember special_member_v = !enabled ? SpecialMember::Deleted : (trivial ? SpecialMember::Trivial : SpecialMember::Provided);
+
+template <typename Base, SpecialMember>
+struct CopyConstructLayer : Base {
+    using Base::Base;
+};
+
+template <typename Base>
+struct CopyConstructLayer<Base, SpecialMember::Provided> : Base {
+    using Base::Base;
+
+    CopyConstructLayer() = default;
+    CopyConstructLayer(CopyConstructLayer const& other) noexcept(Base::NothrowCopyConstruct) :
+        Base()
+    {
+        this->construct_from(other);
+    }
+    CopyConstructLayer(CopyConstructLayer &&) = default;
+    CopyConstructLayer& operator=(CopyConstructLayer const&) = default;
+    CopyConstructLayer& operator=(CopyConstructLayer &&) = default;
+};
+
+template <typename Base>
+struct CopyConstructLayer<Base, SpecialMember::Deleted> : Base {
+    using Base::Base;
+
+    CopyConstructLayer() = default;
+    CopyConstructLayer(CopyConstructLayer const&) = delete;
+    CopyConstructLayer(CopyConstructLayer &&) = default;
+    CopyConstructLayer& operator=(CopyConstructLayer const&) = default;
+    CopyConstructLayer& operator=(CopyConstructLayer &&) = default;
+};
+
+template <typename Base, SpecialMember>
+struct MoveConstructLayer : Base {
+    using Base::Base;
+};
+
+template <typename Base>
+struct MoveConstructLayer<Base, SpecialMember::Provided> : Base {
+    using Base::Base;
+
+    MoveConstructLayer() = default;
+    MoveConstructLayer(MoveConstructLayer const&) = default;
+    MoveConstructLayer(MoveConstructLayer && other) noexcept(Base::NothrowMoveConstruct) :
+        Base()
+    {
+        this->construct_from(std::move(other));
+    }
+    MoveConstructLayer& operator=(MoveConstructLayer const&) = default;
+    MoveConstructLayer& operator=(MoveConstructLayer &&) = default;
+};
+
+template <typename Base>
+struct MoveConstructLayer<Base, SpecialMember::Deleted> : Base {
+    using Base::Base;
+
+    MoveConstructLayer() = default;
+    MoveConstructLayer(MoveConstructLayer const&) = default;
+    MoveConstructLayer(MoveConstructLayer &&) = delete;
+    MoveConstructLayer& operator=(MoveConstructLayer const&) = default;
+    MoveConstructLayer& operator=(MoveConstructLayer &&) = default;
+};
+
+template <typename Base, SpecialMember>
+struct CopyAssignLayer : Base {
+    using Base::Base;
+};
+
+template <typename Base>
+struct CopyAssignLayer<Base, SpecialMember::Provided> : Base {
+    using Base::Base;
+
+    CopyAssignLayer() = default;
+    CopyAssignLayer(CopyAssignLayer const&) = default;
+    CopyAssignLayer(CopyAssignLayer &&) = default;
+    CopyAssignLayer& operator=(CopyAssignLayer const& other) noexcept(Base::NothrowCopyAssign) {
+        this->assign_from(other);
+        return *this;
+    }
+    CopyAssignLayer& operator=(CopyAssignLayer &&) = default;
+};
+
+template <typename Base>
+struct CopyAssignLayer<Base, SpecialMember::Deleted> : Base {
+    using Base::Base;
+
+    CopyAssignLayer() = default;
+    CopyAssignLayer(CopyAssignLayer const&) = default;
+    CopyAssignLayer(CopyAssignLayer &&) = default;
+    CopyAssignLayer& operator=(CopyAssignLayer const&) = delete;
+    CopyAssignLayer& operator=(CopyAssignLayer &&) = default;
+};
+
+template <typename Base, SpecialMember>
+struct MoveAssignLayer : Base {
+    using Base::Base;
+};
+
+template <typename Base>
+struct MoveAssignLayer<Base, SpecialMember::Provided> : Base {
+    using Base::Base;
+
+    MoveAssignLayer() = default;
+    MoveAssignLayer(MoveAssignLayer const&) = default;
+    MoveAssignLayer(MoveAssignLayer &&) = default;
+    MoveAssignLayer& operator=(MoveAssignLayer const&) = default;
+    MoveAssignLayer& operator=(MoveAssignLayer && other) noexcept(Base::NothrowMoveAssign) {
+        this->assign_from(std::move(other));
+        return *this;
+    }
+};
+
+template <typename Base>
+struct MoveAssignLayer<Base, SpecialMember::Deleted> : Base {
+    using Base::Base;
+
+    MoveAssignLayer() = default;
+    MoveAssignLayer(MoveAssignLayer const&) = default;
+    MoveAssignLayer(MoveAssignLayer &&) = default;
+    MoveAssignLayer& operator=(MoveAssignLayer const&) = default;
+    MoveAssignLayer& operator=(MoveAssignLayer &&) = delete;
+};
+
+/*!
+ * \brief The SpecialMembers struct gathers, for a value and message type, how each special member of StatusOptional behaves.
+ *
+ * As for std::optional, a special member is trivial when it is trivial for both payloads,
+ * deleted when one of the payloads does not support it and noexcept when it is noexcept for both payloads.
+ */
+template <typename T, typename MsgT>
+struct SpecialMembers : StorageOps<T, MsgT> {
+    using StorageOps<T, MsgT>::StorageOps;
+
+    static constexpr bool NothrowCopyConstruct = both_v<std::is_nothrow_copy_constructible, T, MsgT>;
+    static constexpr bool NothrowMoveConstruct = both_v<std::is_nothrow_move_constructible, T, MsgT>;
+    static constexpr bool NothrowCopyAssign = NothrowCopyConstruct and both_v<std::is_nothrow_copy_assignable, T, MsgT>;
+    static constexpr bool NothrowMoveAssign = NothrowMoveConstruct and both_v<std::is_nothrow_move_assignable, T, MsgT>;
+
+    static constexpr SpecialMember CopyConstruct =
+            special_member_v<both_v<std::is_trivially_copy_constructible, T, MsgT>,
+                             both_v<std::is_copy_constructible, T, MsgT>>;
+    static constexpr SpecialMember MoveConstruct =
+            special_member_v<both_v<std::is_trivially_move_constructible, T, MsgT>,
+                             both_v<std::is_move_constructible, T, MsgT>>;
+    static constexpr SpecialMember CopyAssign =
+            special_member_v<both_v<std::is_trivially_copy_constructible, T, MsgT> and
+                             both_v<std::is_trivially_copy_assignable, T, MsgT> and
+                             both_v<std::is_trivially_destructible, T, MsgT>,
+                             both_v<std::is_copy_constructible, T, MsgT> and
+                             both_v<std::is_copy_assignable, T, MsgT>>;
+    static constexpr SpecialMember MoveAssign =
+            special_member_v<both_v<std::is_trivially_move_constructible, T, MsgT> and
+                             both_v<std::is_trivially_move_assignable, T, MsgT> and
+                             both_v<std::is_trivially_destructible, T, MsgT>,
+                             both_v<std::is_move_constructible, T, MsgT> and
+                             both_v<std::is_move_assignable, T, MsgT>>;
+};
+
+template <typename T, typename MsgT, typename Members = SpecialMembers<T, MsgT>>
+using Base =
+    MoveAssignLayer<
+        CopyAssignLayer<
+            MoveConstructLayer<
+                CopyConstructLayer<Members, Members::CopyConstruct>,
+            Members::MoveConstruct>,
+        Members::CopyAssign>,
+    Members::MoveAssign>;
+
+template <typename T>
+using remove_cvref_t = std::remove_cv_t<std::remove_reference_t<T>>;
+
+template <typename T>
+struct is_status_optional : std::false_type {};
+
+template <typename T, typename MsgT>
+struct is_status_optional<StatusOptional<T, MsgT>> : std::true_type {};
+
+/*!
+ * \brief converts_from_any_cvref_v tells if T can be built from W, whatever the reference category of W.
+ */
+template <typename T, typename W>
+constexpr bool converts_from_any_cvref_v = std::is_constructible_v<T, W&> or std::is_constructible_v<T, W const&> or
+                                           std::is_constructible_v<T, W&&> or std::is_constructible_v<T, W const&&> or
+                                           std::is_convertible_v<W&, T> or std::is_convertible_v<W const&, T> or
+                                           std::is_convertible_v<W&&, T> or std::is_convertible_v<W const&&, T>;
+
+/*!
+ * \brief converting_v tells if StatusOptional<T, MsgT> has a converting constructor from a StatusOptional<U, M> passed as UArg and MArg payloads.
+ *
+ * As for std::optional, the conversion is disabled when T can be built from the StatusOptional<U, M> itself,
+ * so that a StatusOptional<U, M> keeps converting to a value of type T. A T which can be built from a bool
+ * is always converted, since it could otherwise be built from the StatusOptional<U, M> through operator bool.
+ */
+template <typename T, typename MsgT, typename U, typename M, typename UArg, typename MArg>
+constexpr bool converting_v = !(std::is_same_v<T, U> and std::is_same_v<MsgT, M>) and
+                              std::is_constructible_v<MsgT, MArg> and
+                              (std::is_void_v<T> or
+                               (!std::is_void_v<U> and !std::is_reference_v<U> and
+                                std::is_constructible_v<T, UArg> and
+                                (std::is_constructible_v<T, bool> or !converts_from_any_cvref_v<T, StatusOptional<U, M>>)));
+
+/*!
+ * \brief implicitly_converting_v tells if the converting constructor is implicit: the value converts implicitly (or is dropped for a void target) and the message converts implicitly.
+ */
+template <typename T, typename MsgT, typename U, typename M, typename UArg, typename MArg>
+constexpr bool implicitly_converting_v = std::is_convertible_v<MArg, MsgT> and
+                                         (std::is_void_v<T> ? std::is_void_v<U> : std::is_convertible_v<UArg, T>);
+
+/*!
+ * \brief invoke call a function object (member pointers are not supported, to avoid depending on <functional>).
+ */
+template <typename F, typename... Args>
+inline decltype(auto) invoke(F && f, Args&&... args) {
+    return std::forward<F>(f)(std::forward<Args>(args)...);
+}
+
+template <typename Merge, typename = void>
+struct merge_accumulates : std::false_type {};
+
+template <typename Merge>
+struct merge_accumulates<Merge, std::void_t<decltype(Merge::accumulate)>> : std::bool_constant<Merge::accumulate> {};
+
+/*!
+ * \brief The Access struct implements the operations which need the storage of several StatusOptional types at once.
+ *
+ * The Self parameters are forwarding references to a StatusOptional,
+ * so payloads are copied from lvalues and moved from rvalues.
+ */
+struct Access {
+
+    template <typename Ret>
+    static Ret invalid() {
+        Ret ret;
+        if constexpr (std::is_void_v<typename Ret::ValueType>) {
+            ret._state = NoFlag;
+        }
+        return ret;
+    }
+
+    /*!
+     * \brief failure_from convert the error or invalid state of self to a StatusOptional of another value type.
+     */
+    template <typename Ret, typename Self>
+    static Ret failure_from(Self && self) {
+        if (self.flags() & MessageFlag) {
+            return Ret(InPlaceError(), std::forward<Self>(self)._message._payload);
+        }
+        return invalid<Ret>();
+    }
+
+    template <typename Self, typename F>
+    static auto and_then(Self && self, F && f) {
+        using SO = remove_cvref_t<Self>;
+
+        if constexpr (std::is_void_v<typename SO::ValueType>) {
+            using Ret = remove_cvref_t<std::invoke_result_t<F>>;
+            static_assert(is_status_optional<Ret>::value, "and_then callback must return a StatusOptional");
+            static_assert(std::is_same_v<typename Ret::MessageType, typename SO::MessageType>, "and_then callback must return a StatusOptional with the same message type");
+
+            if (!(self.flags() & ValueFlag)) STATUS_OPTIONAL_UNLIKELY {
+                return failure_from<Ret>(std::forward<Self>(self));
+            }
+            Ret ret = status_optional_detail::invoke(std::forward<F>(f));
+            carry_warning(std::forward<Self>(self), ret);
+            return ret;
+        } else {
+            using ValueRef = decltype(stored_value(std::declval<Self>()));
+            using Ret = remove_cvref_t<std::invoke_result_t<F, ValueRef>>;
+            static_assert(is_status_optional<Ret>::value, "and_then callback must return a StatusOptional");
+            static_assert(std::is_same_v<typename Ret::MessageType, typename SO::MessageType>, "and_then callback must return a StatusOptional with the same message type");
+
+            if (!(self.flags() & ValueFlag)) STATUS_OPTIONAL_UNLIKELY {
+                return failure_from<Ret>(std::forward<Self>(self));
+            }
+            Ret ret = status_optional_detail::invoke(std::forward<F>(f), stored_value(std::forward<Self>(self)));
+            carry_warning(std::forward<Self>(self), ret);
+            return ret;
+        }
+    }
+
+    template <typename Self, typename F>
+    static auto transform(Self && self, F && f) {
+        using SO = remove_cvref_t<Self>;
+        using MsgT = typename SO::MessageType;
+
+        if constexpr (std::is_void_v<typename SO::ValueType>) {
+            using U = remove_cvref_t<std::invoke_result_t<F>>;
+            using Ret = StatusOptional<U, MsgT>;
+
+            if (!(self.flags() & ValueFlag)) STATUS_OPTIONAL_UNLIKELY {
+                return failure_from<Ret>(std::forward<Self>(self));
+            }
+            if constexpr (std::is_void_v<U>) {
+                status_optional_detail::invoke(std::forward<F>(f));
+                return Ret(std::forward<Self>(self));
+            } else if (self.flags() & MessageFlag) {
+                return Ret(InPlaceWarning(), status_optional_detail::invoke(std::forward<F>(f)), std::forward<Self>(self)._message._payload);
+            } else {
+                return Ret(std::in_place, status_optional_detail::invoke(std::forward<F>(f)));
+            }
+        } else {
+            using ValueRef = decltype(stored_value(std::declval<Self>()));
+            using U = remove_cvref_t<std::invoke_result_t<F, ValueRef>>;
+            using Ret = StatusOptional<U, MsgT>;
+
+            if (!(self.flags() & ValueFlag)) STATUS_OPTIONAL_UNLIKELY {
+                return failure_from<Ret>(std::forward<Self>(self));
+            }
+            if constexpr (std::is_void_v<U>) {
+                status_optional_detail::invoke(std::forward<F>(f), stored_value(std::forward<Self>(self)));
+                if (self.flags() & MessageFlag) {
+                    return Ret(InPlaceWarning(), std::forward<Self>(self)._message._payload);
+                }
+                return Ret();
+            } else if (self.flags() & MessageFlag) {
+                return Ret(InPlaceWarning(),
+                           status_optional_detail::invoke(std::forward<F>(f), stored_value(std::forward<Self>(self))),
+                           std::forward<Self>(self)._message._payload);
+            } else {
+                return Ret(std::in_place, status_optional_detail::invoke(std::forward<F>(f), stored_value(std::forward<Self>(self))));
+            }
+        }
+    }
+
+    template <typename Self, typename F>
+    static auto or_else(Self && self, F && f) {
+        using SO = remove_cvref_t<Self>;
+        using MsgRef = decltype(message_of(std::declval<Self>()));
+        using Ret = remove_cvref_t<std::invoke_result_t<F, MsgRef>>;
+        static_assert(std::is_same_v<Ret, SO>, "or_else callback must return a StatusOptional of the same type");
+
+        if (self.flags() == MessageFlag) STATUS_OPTIONAL_UNLIKELY {
+            return Ret(status_optional_detail::invoke(std::forward<F>(f), message_of(std::forward<Self>(self))));
+        }
+        return Ret(std::forward<Self>(self));
+    }
+
+    template <typename Self, typename F>
+    static auto transform_error(Self && self, F && f) {
+        using SO = remove_cvref_t<Self>;
+        using T = typename SO::ValueType;
+        using MsgRef = decltype(message_of(std::declval<Self>()));
+        using M = remove_cvref_t<std::invoke_result_t<F, MsgRef>>;
+        using Ret = StatusOptional<T, M>;
+
+        switch (self.flags()) {
+        case ValueFlag | MessageFlag:
+            if constexpr (std::is_void_v<T>) {
+                return Ret(InPlaceWarning(), status_optional_detail::invoke(std::forward<F>(f), message_of(std::forward<Self>(self))));
+            } else {
+                return Ret(InPlaceWarning(),
+                           stored_value(std::forward<Self>(self)),
+                           status_optional_detail::invoke(std::forward<F>(f), message_of(std::forward<Self>(self))));
+            }
+        case MessageFlag:
+            return Ret(InPlaceError(), status_optional_detail::invoke(std::forward<F>(f), message_of(std::forward<Self>(self))));
+        case ValueFlag:
+            if constexpr (std::is_void_v<T>) {
+                return Ret();
+            } else {
+                return Ret(std::in_place, stored_value(std::forward<Self>(self)));
+            }
+        default:
+            return invalid<Ret>();
+        }
+    }
+
+    template <typename Self, typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    static auto visit(Self && self, OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) {
+        using SO = remove_cvref_t<Self>;
+        using MsgRef = decltype(message_of(std::declval<Self>()));
+
+        if constexpr (std::is_void_v<typename SO::ValueType>) {
+            using Ret = std::common_type_t<std::invoke_result_t<OnOk>,
+                                           std::invoke_result_t<OnWarning, MsgRef>,
+                                           std::invoke_result_t<OnError, MsgRef>,
+                                           std::invoke_result_t<OnInvalid>>;
+            switch (self.state()) {
+            case StatusOptionalState::Ok:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnOk>(onOk)));
+            case StatusOptionalState::Warning:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnWarning>(onWarning), message_of(std::forward<Self>(self))));
+            case StatusOptionalState::Error:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnError>(onError), message_of(std::forward<Self>(self))));
+            case StatusOptionalState::Invalid:
+            default:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnInvalid>(onInvalid)));
+            }
+        } else {
+            using ValueRef = decltype(stored_value(std::declval<Self>()));
+            using Ret = std::common_type_t<std::invoke_result_t<OnOk, ValueRef>,
+                                           std::invoke_result_t<OnWarning, ValueRef, MsgRef>,
+                                           std::invoke_result_t<OnError, MsgRef>,
+                                           std::invoke_result_t<OnInvalid>>;
+            switch (self.state()) {
+            case StatusOptionalState::Ok:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnOk>(onOk), stored_value(std::forward<Self>(self))));
+            case StatusOptionalState::Warning:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnWarning>(onWarning),
+                                                                       stored_value(std::forward<Self>(self)),
+                                                                       message_of(std::forward<Self>(self))));
+            case StatusOptionalState::Error:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnError>(onError), message_of(std::forward<Self>(self))));
+            case StatusOptionalState::Invalid:
+            default:
+                return static_cast<Ret>(status_optional_detail::invoke(std::forward<OnInvalid>(onInvalid)));
+            }
+        }
+    }
+
+    /*!
+     * \brief message_of give access to the message of self as returned by message(), moved from if self is an rvalue.
+     */
+    template <typename Self>
+    static constexpr decltype(auto) message_of(Self && self) {
+        using MsgT = typename remove_cvref_t<Self>::MessageType;
+        if constexpr (std::is_lvalue_reference_v<Self>) {
+            return status_message_traits<MsgT>::get(self._message._payload);
+        } else {
+            return std::move(status_message_traits<MsgT>::get(self._message._payload));
+        }
+    }
+
+    /*!
+     * \brief succeeded tells if self holds a value, or for StatusOptional<void, MsgT> if it is an ok status or a warning.
+     */
+    template <typename Self>
+    static constexpr bool succeeded(Self const& self) {
+        return self.flags() & ValueFlag;
+    }
+
+    /*!
+     * \brief stored_value give access to the value of self as stored, moved from if self is an rvalue.
+     *
+     * For a StatusOptional<T&, MsgT>, which stores a pointer, it is the referred T.
+     */
+    template <typename Self>
+    static constexpr decltype(auto) stored_value(Self && self) {
+        if constexpr (std::is_reference_v<typename remove_cvref_t<Self>::ValueType>) {
+            return (*self._value._payload);
+        } else {
+            return (std::forward<Self>(self)._value._payload);
+        }
+    }
+
+    /*!
+     * \brief stored_message give access to the message of self as stored (of type MsgT), moved from if self is an rvalue.
+     */
+    template <typename Self>
+    static constexpr decltype(auto) stored_message(Self && self) {
+        return (std::forward<Self>(self)._message._payload);
+    }
+
+    /*!
+     * \brief attach_warning turn self, which holds a value (or is an ok status) without message, into a warning with the message built from args.
+     */
+    template <typename Self, typename... Args>
+    static void attach_warning(Self & self, Args&&... args) {
+        self.construct_message(std::forward<Args>(args)...);
+    }
+
+protected:
+
+    /*!
+     * \brief carry_warning attach the warning of self to ret, if ret holds a value without message.
+     *
+     * If ret already holds a message, the message of the newer StatusOptional is kept,
+     * unless status_message_merge<MsgT>::accumulate is true and ret is a warning, in which case the message of ret is appended to the warning of self.
+     */
+    template <typename Self, typename Ret>
+    static void carry_warning(Self && self, Ret & ret) {
+        using MsgT = typename Ret::MessageType;
+        if (!(self.flags() & MessageFlag)) {
+            return;
+        }
+        if (ret.flags() == ValueFlag) {
+            ret.construct_message(std::forward<Self>(self)._message._payload);
+        } else if constexpr (merge_accumulates<status_message_merge<MsgT>>::value) {
+            if (ret.flags() == (ValueFlag | MessageFlag)) {
+                MsgT merged(std::forward<Self>(self)._message._payload);
+                status_message_merge<MsgT>::merge(merged, std::move(ret._message._payload));
+                ret._message._payload = std::move(merged);
+            }
+        }
+    }
+};
+
+} // namespace status_optional_detail
+
+/*!
+ * \brief The StatusOptional class represent an optional value, with an optional message.
+ *
+ * StatusOptional<T, MsgT> can be constructed from a value of Type T, representing an instance of T,
+ * using the special function StatusOptional<T, MsgT> StatusOptional<T, MsgT>::warning(T const& val, MsgT const& msg),
+ * it is also possible to create a StatusOptional representing T, but also containing an additional message
+ * giving some information about the warning. Finally, using the function
+ * StatusOptional<T, MsgT> StatusOptional<T, MsgT>::error(MsgT const& msg), it is possible to return a message
+ * instead of a value.
+ *
+ * The value and the message live in raw storage next to a single discriminant byte,
+ * so only the payloads of the current state are ever constructed,
+ * and the object is only one byte (plus padding) larger than a value and a message side by side.
+ *
+ * The also exist a specialization StatusOptional<void, MsgT>, which contains no value but still
+ * indicate if the results is valid (no message provided), is a warning (a message was provided, but not as an error)
+ * or an error (a message has been provided and should be treated as an error).
+ */
+template <typename T, typename MsgT>
+class StatusOptional : protected status_optional_detail::Base<T, MsgT> {
+protected:
+
+    using Base = status_optional_detail::Base<T, MsgT>;
+
+    friend struct status_optional_detail::Access;
+
+    template <typename, typename>
+    friend class StatusOptional;
+
+    template <typename... Args>
+    constexpr explicit StatusOptional(status_optional_detail::InPlaceError tag, Args&&... args) :
+        Base(tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename V, typename M>
+    constexpr StatusOptional(status_optional_detail::InPlaceWarning tag, V && val, M && msg) :
+        Base(tag, std::forward<V>(val), std::forward<M>(msg))
+    {
+
+    }
+
+    template <typename... VArgs, typename... MArgs>
+    constexpr StatusOptional(std::piecewise_construct_t tag, std::tuple<VArgs...> valArgs, std::tuple<MArgs...> msgArgs) :
+        Base(tag, std::move(valArgs), std::move(msgArgs))
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr StatusOptional(std::allocator_arg_t, Alloc const& alloc, status_optional_detail::InPlaceError tag, Args&&... args) :
+        Base(std::allocator_arg, alloc, tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr StatusOptional(std::allocator_arg_t, Alloc const& alloc, status_optional_detail::InPlaceWarning tag, Args&&... args) :
+        Base(std::allocator_arg, alloc, tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+public:
+
+    typedef T ValueType;
+    typedef MsgT MessageType;
+
+    static constexpr StatusOptional<T, MsgT> warning(T const& val, MsgT const& msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceWarning(), val, msg);
+    }
+
+    static constexpr StatusOptional<T, MsgT> warning(T && val, MsgT const& msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceWarning(), std::move(val), msg);
+    }
+
+    static constexpr StatusOptional<T, MsgT> warning(T const& val, MsgT && msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceWarning(), val, std::move(msg));
+    }
+
+    static constexpr StatusOptional<T, MsgT> warning(T && val, MsgT && msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceWarning(), std::move(val), std::move(msg));
+    }
+
+    /*!
+     * \brief warning_in_place build a warning, constructing the value and the message directly in the returned StatusOptional
+     * \param valArgs the arguments of the value constructor (e.g. from std::forward_as_tuple)
+     * \param msgArgs the arguments of the message constructor (e.g. from std::forward_as_tuple)
+     *
+     * Use as StatusOptional<T, MsgT>::warning_in_place(std::piecewise_construct, std::forward_as_tuple(...), std::forward_as_tuple(...)).
+     */
+    template <typename... VArgs, typename... MArgs>
+    static constexpr StatusOptional<T, MsgT> warning_in_place(std::piecewise_construct_t, std::tuple<VArgs...> valArgs, std::tuple<MArgs...> msgArgs STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T, MsgT>(std::piecewise_construct, std::move(valArgs), std::move(msgArgs));
+    }
+
+    static constexpr StatusOptional<T, MsgT> error(MsgT const& msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceError(), msg);
+    }
+
+    static constexpr StatusOptional<T, MsgT> error(MsgT && msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceError(), std::move(msg));
+    }
+
+    /*!
+     * \brief error_in_place build an error, constructing the message from args directly in the returned StatusOptional
+     */
+    template <typename... Args>
+    static constexpr StatusOptional<T, MsgT> error_in_place(Args&&... args) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Error);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceError(), std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief error_from build an error whose message is returned by formatter, in a function kept out of line.
+     *
+     * The code formatting the message is compiled in error_from rather than in the caller,
+     * so a hot loop which can fail only pays for a call on its failure path:
+     *
+     * \code
+     * return StatusOptional<T>::error_from([&] () { return "Invalid record " + std::to_string(id); });
+     * \endcode
+     */
+    template <typename F>
+    STATUS_OPTIONAL_COLD static StatusOptional<T, MsgT> error_from(F && formatter STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceError(), status_optional_detail::invoke(std::forward<F>(formatter)));
+    }
+
+    /*!
+     * \brief warning_from build a warning whose message is returned by formatter, in a function kept out of line, as error_from does.
+     */
+    template <typename V, typename F>
+    STATUS_OPTIONAL_COLD static StatusOptional<T, MsgT> warning_from(V && val, F && formatter STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T, MsgT>(status_optional_detail::InPlaceWarning(), std::forward<V>(val), status_optional_detail::invoke(std::forward<F>(formatter)));
+    }
+
+    /*!
+     * \brief warning build a warning with uses-allocator construction of the value and of the message (built from msgArgs)
+     */
+    template <typename Alloc, typename V, typename... Args>
+    static constexpr StatusOptional<T, MsgT> warning(std::allocator_arg_t, Alloc const& alloc, V && val, Args&&... msgArgs) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Warning);
+        return StatusOptional<T, MsgT>(std::allocator_arg, alloc, status_optional_detail::InPlaceWarning(), std::forward<V>(val), std::forward<Args>(msgArgs)...);
+    }
+
+    /*!
+     * \brief error build an error with uses-allocator construction of the message (built from msgArgs)
+     */
+    template <typename Alloc, typename... Args>
+    static constexpr StatusOptional<T, MsgT> error(std::allocator_arg_t, Alloc const& alloc, Args&&... msgArgs) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Error);
+        return StatusOptional<T, MsgT>(std::allocator_arg, alloc, status_optional_detail::InPlaceError(), std::forward<Args>(msgArgs)...);
+    }
+
+
+    constexpr StatusOptional() = default;
+
+    constexpr StatusOptional(T const& val) :
+        Base(std::in_place, val)
+    {
+
+    }
+
+    constexpr StatusOptional(T && val) :
+        Base(std::in_place, std::move(val))
+    {
+
+    }
+
+    /*!
+     * \brief Construct a StatusOptional holding a value built in place from args, with no message
+     */
+    template <typename... Args>
+    constexpr explicit StatusOptional(std::in_place_t, Args&&... args) :
+        Base(std::in_place, std::forward<Args>(args)...)
+    {
+
+    }
+
+    /*!
+     * \brief Construct a StatusOptional holding a value built in place from args with uses-allocator construction
+     */
+    template <typename Alloc, typename... Args>
+    constexpr StatusOptional(std::allocator_arg_t, Alloc const& alloc, std::in_place_t, Args&&... args) :
+        Base(std::allocator_arg, alloc, std::in_place, std::forward<Args>(args)...)
+    {
+
+    }
+
+    /*!
+     * \brief Copy other, using uses-allocator construction for the payloads
+     */
+    template <typename Alloc>
+    StatusOptional(std::allocator_arg_t, Alloc const& alloc, StatusOptional<T, MsgT> const& other) :
+        Base()
+    {
+        this->construct_from_with_allocator(alloc, static_cast<Base const&>(other));
+    }
+
+    /*!
+     * \brief Move other, using uses-allocator construction for the payloads
+     */
+    template <typename Alloc>
+    StatusOptional(std::allocator_arg_t, Alloc const& alloc, StatusOptional<T, MsgT> && other) :
+        Base()
+    {
+        this->construct_from_with_allocator(alloc, static_cast<Base &&>(other));
+    }
+
+    /*!
+     * \brief Convert other, a StatusOptional with another value or message type, in the same state.
+     *
+     * As for std::optional, the conversion is implicit when the value and the message convert implicitly, and explicit otherwise. The payloads are moved when other is an rvalue.
+     */
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<T, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&> and
+                               status_optional_detail::implicitly_converting_v<T, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&>, bool> = true>
+    StatusOptional(StatusOptional<U, M> const& other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base const&>(other));
+    }
+
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<T, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&> and
+                               !status_optional_detail::implicitly_converting_v<T, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&>, bool> = true>
+    explicit StatusOptional(StatusOptional<U, M> const& other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base const&>(other));
+    }
+
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<T, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&> and
+                               status_optional_detail::implicitly_converting_v<T, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&>, bool> = true>
+    StatusOptional(StatusOptional<U, M> && other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base &&>(other));
+    }
+
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<T, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&> and
+                               !status_optional_detail::implicitly_converting_v<T, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&>, bool> = true>
+    explicit StatusOptional(StatusOptional<U, M> && other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base &&>(other));
+    }
+
+    StatusOptional<T,MsgT>& operator=(T const& val) {
+        this->assign_value(val);
+        this->destroy_message();
+        return *this;
+    }
+
+    StatusOptional<T,MsgT>& operator=(T && val) {
+        this->assign_value(std::move(val));
+        this->destroy_message();
+        return *this;
+    }
+
+    /*!
+     * \brief emplace_value replace the content of the StatusOptional by a value built in place from args, with no message
+     * \return a reference to the new value
+     */
+    template <typename... Args>
+    T& emplace_value(Args&&... args) {
+        this->destroy_value();
+        this->destroy_message();
+        this->construct_value(std::forward<Args>(args)...);
+        return this->_value._payload;
+    }
+
+    /*!
+     * \brief emplace_message replace the message by a message built in place from args, turning a value into a warning and anything else into an error
+     * \return a reference to the new message
+     *
+     * When status_message_reuse<MsgT>::keep_capacity is true the message dropped earlier is assigned to, and keeps its buffer.
+     */
+    template <typename... Args>
+    typename status_message_traits<MsgT>::value_type& emplace_message(Args&&... args) {
+        this->destroy_message();
+        this->construct_message(std::forward<Args>(args)...);
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    /*!
+     * \brief set_warning turn the StatusOptional into a warning, assigning to the value and to the message in place when they are there
+     */
+    template <typename V, typename M>
+    StatusOptional<T,MsgT>& set_warning(V && val, M && msg) {
+        this->assign_value(std::forward<V>(val));
+        this->assign_message(std::forward<M>(msg));
+        return *this;
+    }
+
+    /*!
+     * \brief set_error turn the StatusOptional into an error, dropping the value and assigning to the message in place when there is one
+     */
+    template <typename M>
+    StatusOptional<T,MsgT>& set_error(M && msg) {
+        this->destroy_value();
+        this->assign_message(std::forward<M>(msg));
+        return *this;
+    }
+
+    /*!
+     * \brief reset drop the value and the message, leaving the StatusOptional invalid, as if default constructed
+     */
+    void reset() {
+        this->destroy_value();
+        this->destroy_message();
+    }
+
+    constexpr operator bool() const{
+        return has_value();
+    }
+
+    constexpr bool has_value() const {
+        return this->flags() & status_optional_detail::ValueFlag;
+    }
+
+    constexpr T& value() {
+        if (!has_value()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return this->_value._payload;
+    }
+
+    constexpr T const& value() const {
+        if (!has_value()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return this->_value._payload;
+    }
+
+    /*!
+     * \brief operator* access the value without checking that there is one, which is only asserted when STATUS_OPTIONAL_DEBUG is defined.
+     *
+     * Use it once has_value() has been tested, it compiles to a plain access without the throwing branch of value().
+     */
+    constexpr T& operator*() {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return this->_value._payload;
+    }
+
+    constexpr T const& operator*() const {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return this->_value._payload;
+    }
+
+    constexpr T* operator ->() {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return status_optional_detail::address_of(this->_value._payload);
+    }
+
+    constexpr T const* operator ->() const {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return status_optional_detail::address_of(this->_value._payload);
+    }
+
+    /*!
+     * \brief unchecked_value access the value without checking that there is one, as operator* does.
+     */
+    constexpr T& unchecked_value() {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return this->_value._payload;
+    }
+
+    constexpr T const& unchecked_value() const {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return this->_value._payload;
+    }
+
+    /*!
+     * \brief value_or return a copy of the value, or alt converted to T if there is no value
+     */
+    template <typename U = T>
+    constexpr T value_or(U && alt) const& {
+        if (has_value()) {
+            return this->_value._payload;
+        }
+        return static_cast<T>(std::forward<U>(alt));
+    }
+
+    /*!
+     * \brief value_or return the value moved out of the StatusOptional, or alt converted to T if there is no value
+     */
+    template <typename U = T>
+    constexpr T value_or(U && alt) && {
+        if (has_value()) {
+            return std::move(this->_value._payload);
+        }
+        return static_cast<T>(std::forward<U>(alt));
+    }
+
+    /*!
+     * \brief value_or_else return a copy of the value, or the result of f() if there is no value
+     *
+     * Unlike value_or, the fallback is only built when it is needed.
+     */
+    template <typename F>
+    constexpr T value_or_else(F && f) const& {
+        if (has_value()) {
+            return this->_value._payload;
+        }
+        return static_cast<T>(std::forward<F>(f)());
+    }
+
+    /*!
+     * \brief value_or_else return the value moved out of the StatusOptional, or the result of f() if there is no value
+     */
+    template <typename F>
+    constexpr T value_or_else(F && f) && {
+        if (has_value()) {
+            return std::move(this->_value._payload);
+        }
+        return static_cast<T>(std::forward<F>(f)());
+    }
+
+    constexpr bool has_message() const {
+        return this->flags() & status_optional_detail::MessageFlag;
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type& message() {
+        if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type const& message() const {
+        if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    /*!
+     * \brief unchecked_message access the message without checking that there is one, which is only asserted when STATUS_OPTIONAL_DEBUG is defined.
+     */
+    constexpr typename status_message_traits<MsgT>::value_type& unchecked_message() {
+        STATUS_OPTIONAL_ASSERT(has_message());
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type const& unchecked_message() const {
+        STATUS_OPTIONAL_ASSERT(has_message());
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+
+    /*!
+     * \brief is_valid indicate if the StatusOptional is valid (i.e. is not default constructed)
+     * \return true if the StatusOptional is valid
+     */
+    constexpr bool is_valid() const {
+        return this->flags() != status_optional_detail::NoFlag;
+    }
+
+    /*!
+     * \brief is_no_error_or_warning indicate if the StatusOptional is not an error or warning
+     * \return true if the StatusOptional is valid and is not an error or warning
+     *
+     * the StatusOptional is no error or warning if it has a value, and no message
+     */
+    constexpr bool is_no_error_or_warning() const {
+        return this->flags() == status_optional_detail::ValueFlag;
+    }
+    /*!
+     * \brief is_clean indicate if the StatusOptional is a warning
+     * \return true if the StatusOptional is a warning
+     *
+     * the StatusOptional is a warning if it has a value, but also a message
+     * (e.g. a function could compute a result, but additional care is needed, or something needs to be logged).
+     */
+    constexpr bool is_warning() const {
+        return this->flags() == (status_optional_detail::ValueFlag | status_optional_detail::MessageFlag);
+    }
+
+    /*!
+     * \brief is_clean indicate if the StatusOptional is an error
+     * \return true if the StatusOptional is an error
+     *
+     * the StatusOptional is an error if it has no value. In that case, a message has to be present.
+     */
+    constexpr bool is_error() const {
+        return this->flags() == status_optional_detail::MessageFlag;
+    }
+
+    /*!
+     * \brief state return the state of the StatusOptional, read at once, to switch on.
+     */
+    constexpr StatusOptionalState state() const {
+        return static_cast<StatusOptionalState>(this->flags());
+    }
+
+    /*!
+     * \brief visit call the function matching the state of the StatusOptional, and return its result
+     * \param onOk called with the value, for a value without message
+     * \param onWarning called with the value and the message, for a warning
+     * \param onError called with the message, for an error
+     * \param onInvalid called without arguments, for a default constructed StatusOptional
+     *
+     * The results of the four functions must have a common type. Called on an rvalue, the payloads are passed as rvalues.
+     */
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) & {
+        return status_optional_detail::Access::visit(*this, std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) const& {
+        return status_optional_detail::Access::visit(*this, std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) && {
+        return status_optional_detail::Access::visit(std::move(*this), std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    /*!
+     * \brief and_then call f with the value, and return the StatusOptional returned by f
+     * \param f a function taking the value and returning a StatusOptional<U, MsgT>
+     * \return the result of f, or the error (or invalid state) of *this converted to StatusOptional<U, MsgT>
+     *
+     * If *this is a warning and f returns a value without message, the warning message is carried to the result.
+     * Called on an rvalue, the value and the message are moved rather than copied.
+     */
+    template <typename F>
+    auto and_then(F && f) & {
+        return status_optional_detail::Access::and_then(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto and_then(F && f) const& {
+        return status_optional_detail::Access::and_then(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto and_then(F && f) && {
+        return status_optional_detail::Access::and_then(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief transform call f with the value, and return its result wrapped in a StatusOptional<U, MsgT>
+     * \param f a function taking the value and returning a U (possibly void)
+     * \return a StatusOptional<U, MsgT> with the result of f and the warning message of *this if any,
+     * or the error (or invalid state) of *this.
+     */
+    template <typename F>
+    auto transform(F && f) & {
+        return status_optional_detail::Access::transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform(F && f) const& {
+        return status_optional_detail::Access::transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform(F && f) && {
+        return status_optional_detail::Access::transform(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief or_else call f with the message if *this is an error
+     * \param f a function taking the message and returning a StatusOptional of the same type
+     * \return the result of f if *this is an error, else a copy of *this (moved from *this when called on an rvalue).
+     */
+    template <typename F>
+    auto or_else(F && f) & {
+        return status_optional_detail::Access::or_else(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto or_else(F && f) const& {
+        return status_optional_detail::Access::or_else(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto or_else(F && f) && {
+        return status_optional_detail::Access::or_else(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief transform_error convert the message of a warning or an error using f
+     * \param f a function taking the message and returning a M
+     * \return a StatusOptional<ValueType, M> in the same state as *this.
+     */
+    template <typename F>
+    auto transform_error(F && f) & {
+        return status_optional_detail::Access::transform_error(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform_error(F && f) const& {
+        return status_optional_detail::Access::transform_error(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform_error(F && f) && {
+        return status_optional_detail::Access::transform_error(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief propagate_error move the error (or invalid state) of *this to a StatusOptional<U, MsgT>.
+     *
+     * *this must not hold a value: a value or a warning throws std::bad_optional_access, as value() does, rather than
+     * turning the warning into an error.
+     *
+     * The message is moved exactly once, where and_then or error(message()) would move or copy it through a temporary.
+     */
+    template <typename U>
+    StatusOptional<U, MsgT> propagate_error() && {
+        if (has_value()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_optional_detail::Access::failure_from<StatusOptional<U, MsgT>>(std::move(*this));
+    }
+};
+
+template <typename MsgT>
+class StatusOptional<void, MsgT> : protected status_optional_detail::Base<void, MsgT> {
+protected:
+
+    using Base = status_optional_detail::Base<void, MsgT>;
+
+    friend struct status_optional_detail::Access;
+
+    template <typename, typename>
+    friend class StatusOptional;
+
+    template <typename... Args>
+    constexpr explicit StatusOptional(status_optional_detail::InPlaceError tag, Args&&... args) :
+        Base(tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename... Args>
+    constexpr explicit StatusOptional(status_optional_detail::InPlaceWarning tag, Args&&... args) :
+        Base(tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr StatusOptional(std::allocator_arg_t, Alloc const& alloc, status_optional_detail::InPlaceError tag, Args&&... args) :
+        Base(std::allocator_arg, alloc, tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename Alloc, typename... Args>
+    constexpr StatusOptional(std::allocator_arg_t, Alloc const& alloc, status_optional_detail::InPlaceWarning tag, Args&&... args) :
+        Base(std::allocator_arg, alloc, tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+public:
+
+    typedef void ValueType;
+    typedef MsgT MessageType;
+
+    static constexpr StatusOptional<void, MsgT> warning(MsgT const& msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceWarning(), msg);
+    }
+
+    static constexpr StatusOptional<void, MsgT> warning(MsgT && msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceWarning(), std::move(msg));
+    }
+
+    /*!
+     * \brief warning_in_place build a warning, constructing the message from args directly in the returned StatusOptional
+     */
+    template <typename... Args>
+    static constexpr StatusOptional<void, MsgT> warning_in_place(Args&&... args) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Warning);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceWarning(), std::forward<Args>(args)...);
+    }
+
+    static constexpr StatusOptional<void, MsgT> error(MsgT const& msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceError(), msg);
+    }
+
+    static constexpr StatusOptional<void, MsgT> error(MsgT && msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceError(), std::move(msg));
+    }
+
+    /*!
+     * \brief error_in_place build an error, constructing the message from args directly in the returned StatusOptional
+     */
+    template <typename... Args>
+    static constexpr StatusOptional<void, MsgT> error_in_place(Args&&... args) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Error);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceError(), std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief error_from build an error whose message is returned by formatter, in a function kept out of line.
+     */
+    template <typename F>
+    STATUS_OPTIONAL_COLD static StatusOptional<void, MsgT> error_from(F && formatter STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceError(), status_optional_detail::invoke(std::forward<F>(formatter)));
+    }
+
+    /*!
+     * \brief warning_from build a warning whose message is returned by formatter, in a function kept out of line.
+     */
+    template <typename F>
+    STATUS_OPTIONAL_COLD static StatusOptional<void, MsgT> warning_from(F && formatter STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<void, MsgT>(status_optional_detail::InPlaceWarning(), status_optional_detail::invoke(std::forward<F>(formatter)));
+    }
+
+    /*!
+     * \brief warning build a warning with uses-allocator construction of the message (built from msgArgs)
+     */
+    template <typename Alloc, typename... Args>
+    static constexpr StatusOptional<void, MsgT> warning(std::allocator_arg_t, Alloc const& alloc, Args&&... msgArgs) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Warning);
+        return StatusOptional<void, MsgT>(std::allocator_arg, alloc, status_optional_detail::InPlaceWarning(), std::forward<Args>(msgArgs)...);
+    }
+
+    /*!
+     * \brief error build an error with uses-allocator construction of the message (built from msgArgs)
+     */
+    template <typename Alloc, typename... Args>
+    static constexpr StatusOptional<void, MsgT> error(std::allocator_arg_t, Alloc const& alloc, Args&&... msgArgs) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Error);
+        return StatusOptional<void, MsgT>(std::allocator_arg, alloc, status_optional_detail::InPlaceError(), std::forward<Args>(msgArgs)...);
+    }
+
+
+    constexpr StatusOptional() = default;
+
+    /*!
+     * \brief Copy other, using uses-allocator construction for the message
+     */
+    template <typename Alloc>
+    StatusOptional(std::allocator_arg_t, Alloc const& alloc, StatusOptional<void, MsgT> const& other) :
+        Base()
+    {
+        this->construct_from_with_allocator(alloc, static_cast<Base const&>(other));
+    }
+
+    /*!
+     * \brief Move other, using uses-allocator construction for the message
+     */
+    template <typename Alloc>
+    StatusOptional(std::allocator_arg_t, Alloc const& alloc, StatusOptional<void, MsgT> && other) :
+        Base()
+    {
+        this->construct_from_with_allocator(alloc, static_cast<Base &&>(other));
+    }
+
+    /*!
+     * \brief Convert other, a StatusOptional with another value or message type, in the same state.
+     *
+     * The value of other, if any, is dropped, so the conversion from a StatusOptional<U, M> with a non void U is explicit, and the conversion from a StatusOptional<void, M> is implicit when the message converts implicitly. The payloads are moved when other is an rvalue.
+     */
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<void, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&> and
+                               status_optional_detail::implicitly_converting_v<void, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&>, bool> = true>
+    StatusOptional(StatusOptional<U, M> const& other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base const&>(other));
+    }
+
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<void, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&> and
+                               !status_optional_detail::implicitly_converting_v<void, MsgT, U, M, std::add_lvalue_reference_t<U const>, M const&>, bool> = true>
+    explicit StatusOptional(StatusOptional<U, M> const& other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base const&>(other));
+    }
+
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<void, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&> and
+                               status_optional_detail::implicitly_converting_v<void, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&>, bool> = true>
+    StatusOptional(StatusOptional<U, M> && other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base &&>(other));
+    }
+
+    template <typename U, typename M,
+              std::enable_if_t<status_optional_detail::converting_v<void, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&> and
+                               !status_optional_detail::implicitly_converting_v<void, MsgT, U, M, std::add_rvalue_reference_t<U>, M&&>, bool> = true>
+    explicit StatusOptional(StatusOptional<U, M> && other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U, M>::Base &&>(other));
+    }
+
+    /*!
+     * \brief emplace_message replace the message by a message built in place from args, turning a success into a warning and anything else into an error
+     * \return a reference to the new message
+     *
+     * When status_message_reuse<MsgT>::keep_capacity is true the message dropped earlier is assigned to, and keeps its buffer.
+     */
+    template <typename... Args>
+    typename status_message_traits<MsgT>::value_type& emplace_message(Args&&... args) {
+        this->destroy_message();
+        this->construct_message(std::forward<Args>(args)...);
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    /*!
+     * \brief set_warning turn the StatusOptional into a warning, assigning to the message in place when there is one
+     */
+    template <typename M>
+    StatusOptional<void, MsgT>& set_warning(M && msg) {
+        this->_state |= status_optional_detail::ValueFlag;
+        this->assign_message(std::forward<M>(msg));
+        return *this;
+    }
+
+    /*!
+     * \brief set_error turn the StatusOptional into an error, assigning to the message in place when there is one
+     */
+    template <typename M>
+    StatusOptional<void, MsgT>& set_error(M && msg) {
+        this->_state &= ~status_optional_detail::ValueFlag;
+        this->assign_message(std::forward<M>(msg));
+        return *this;
+    }
+
+    /*!
+     * \brief reset drop the message, leaving a success without message, as if default constructed
+     */
+    void reset() {
+        this->_state |= status_optional_detail::ValueFlag;
+        this->destroy_message();
+    }
+
+    constexpr operator bool() const{
+        return this->flags() & status_optional_detail::ValueFlag;
+    }
+
+    constexpr bool has_message() const {
+        return this->flags() & status_optional_detail::MessageFlag;
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type& message() {
+        if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type const& message() const {
+        if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    /*!
+     * \brief unchecked_message access the message without checking that there is one, which is only asserted when STATUS_OPTIONAL_DEBUG is defined.
+     */
+    constexpr typename status_message_traits<MsgT>::value_type& unchecked_message() {
+        STATUS_OPTIONAL_ASSERT(has_message());
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type const& unchecked_message() const {
+        STATUS_OPTIONAL_ASSERT(has_message());
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+
+    /*!
+     * \brief is_valid indicate if the StatusOptional is valid (i.e. is not default constructed)
+     * \return true if the StatusOptional is valid
+     */
+    constexpr bool is_valid() const {
+        return this->flags() != status_optional_detail::NoFlag;
+    }
+
+    /*!
+     * \brief is_no_error_or_warning indicate if the StatusOptional is not an error or warning
+     * \return true if the StatusOptional is valid and is not an error or warning
+     *
+     * the StatusOptional is no error or warning if it has a value, and no message
+     */
+    constexpr bool is_no_error_or_warning() const {
+        return this->flags() == status_optional_detail::ValueFlag;
+    }
+    /*!
+     * \brief is_clean indicate if the StatusOptional is a warning
+     * \return true if the StatusOptional is a warning
+     *
+     * the StatusOptional is a warning if it has a value, but also a message
+     * (e.g. a function could compute a result, but additional care is needed, or something needs to be logged).
+     */
+    constexpr bool is_warning() const {
+        return this->flags() == (status_optional_detail::ValueFlag | status_optional_detail::MessageFlag);
+    }
+
+    /*!
+     * \brief is_clean indicate if the StatusOptional is an error
+     * \return true if the StatusOptional is an error
+     *
+     * the StatusOptional is an error if it has no value. In that case, a message has to be present.
+     */
+    constexpr bool is_error() const {
+        return this->flags() == status_optional_detail::MessageFlag;
+    }
+
+    /*!
+     * \brief state return the state of the StatusOptional, read at once, to switch on.
+     */
+    constexpr StatusOptionalState state() const {
+        return static_cast<StatusOptionalState>(this->flags());
+    }
+
+    /*!
+     * \brief visit call the function matching the state of the StatusOptional, and return its result
+     * \param onOk called without arguments, for a valid status without message
+     * \param onWarning called with the message, for a warning
+     * \param onError called with the message, for an error
+     * \param onInvalid called without arguments, for an invalid StatusOptional
+     *
+     * The results of the four functions must have a common type. Called on an rvalue, the payloads are passed as rvalues.
+     */
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) & {
+        return status_optional_detail::Access::visit(*this, std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) const& {
+        return status_optional_detail::Access::visit(*this, std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) && {
+        return status_optional_detail::Access::visit(std::move(*this), std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    /*!
+     * \brief and_then call f if *this is valid and not an error, and return the StatusOptional returned by f
+     * \param f a function without parameters returning a StatusOptional<U, MsgT>
+     * \return the result of f, or the error (or invalid state) of *this converted to StatusOptional<U, MsgT>
+     *
+     * If *this is a warning and f returns a value without message, the warning message is carried to the result.
+     * Called on an rvalue, the value and the message are moved rather than copied.
+     */
+    template <typename F>
+    auto and_then(F && f) & {
+        return status_optional_detail::Access::and_then(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto and_then(F && f) const& {
+        return status_optional_detail::Access::and_then(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto and_then(F && f) && {
+        return status_optional_detail::Access::and_then(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief transform call f if *this is valid and not an error, and return its result wrapped in a StatusOptional<U, MsgT>
+     * \param f a function without parameters returning a U (possibly void)
+     * \return a StatusOptional<U, MsgT> with the result of f and the warning message of *this if any,
+     * or the error (or invalid state) of *this.
+     */
+    template <typename F>
+    auto transform(F && f) & {
+        return status_optional_detail::Access::transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform(F && f) const& {
+        return status_optional_detail::Access::transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform(F && f) && {
+        return status_optional_detail::Access::transform(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief or_else call f with the message if *this is an error
+     * \param f a function taking the message and returning a StatusOptional of the same type
+     * \return the result of f if *this is an error, else a copy of *this (moved from *this when called on an rvalue).
+     */
+    template <typename F>
+    auto or_else(F && f) & {
+        return status_optional_detail::Access::or_else(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto or_else(F && f) const& {
+        return status_optional_detail::Access::or_else(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto or_else(F && f) && {
+        return status_optional_detail::Access::or_else(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief transform_error convert the message of a warning or an error using f
+     * \param f a function taking the message and returning a M
+     * \return a StatusOptional<void, M> in the same state as *this.
+     */
+    template <typename F>
+    auto transform_error(F && f) & {
+        return status_optional_detail::Access::transform_error(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform_error(F && f) const& {
+        return status_optional_detail::Access::transform_error(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform_error(F && f) && {
+        return status_optional_detail::Access::transform_error(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief propagate_error move the error (or invalid state) of *this to a StatusOptional<U, MsgT>.
+     *
+     * *this must not be ok nor a warning, which throw std::bad_optional_access as message() does, rather than
+     * turning the warning into an error.
+     *
+     * The message is moved exactly once, where and_then or error(message()) would move or copy it through a temporary.
+     */
+    template <typename U>
+    StatusOptional<U, MsgT> propagate_error() && {
+        if (status_optional_detail::Access::succeeded(*this)) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_optional_detail::Access::failure_from<StatusOptional<U, MsgT>>(std::move(*this));
+    }
+};
+
+/*!
+ * \brief StatusOptional<T&, MsgT> refers to a value owned elsewhere, such as an entry of a cache, instead of holding a copy.
+ *
+ * It stores a pointer to the value, so a hit costs one pointer and the value is never copied.
+ * The value must outlive the StatusOptional: the constructors and factories do not accept temporaries.
+ * value() and operator* return a T& even on a const StatusOptional, as a pointer would, and value_or returns a copy.
+ * Copying a StatusOptional<T&, MsgT> copies the reference, and assigning one rebinds it.
+ */
+template <typename T, typename MsgT>
+class StatusOptional<T&, MsgT> : protected status_optional_detail::Base<T*, MsgT> {
+protected:
+
+    using Base = status_optional_detail::Base<T*, MsgT>;
+
+    friend struct status_optional_detail::Access;
+
+    template <typename, typename>
+    friend class StatusOptional;
+
+    template <typename... Args>
+    constexpr explicit StatusOptional(status_optional_detail::InPlaceError tag, Args&&... args) :
+        Base(tag, std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename M>
+    constexpr StatusOptional(status_optional_detail::InPlaceWarning tag, T& val, M && msg) :
+        Base(tag, status_optional_detail::address_of(val), std::forward<M>(msg))
+    {
+
+    }
+
+public:
+
+    typedef T& ValueType;
+    typedef MsgT MessageType;
+
+    static constexpr StatusOptional<T&, MsgT> warning(T& val, MsgT const& msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T&, MsgT>(status_optional_detail::InPlaceWarning(), val, msg);
+    }
+
+    static constexpr StatusOptional<T&, MsgT> warning(T& val, MsgT && msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T&, MsgT>(status_optional_detail::InPlaceWarning(), val, std::move(msg));
+    }
+
+    static StatusOptional<T&, MsgT> warning(std::remove_const_t<T> && val, MsgT const& msg) = delete;
+    static StatusOptional<T&, MsgT> warning(std::remove_const_t<T> && val, MsgT && msg) = delete;
+
+    static constexpr StatusOptional<T&, MsgT> error(MsgT const& msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<T&, MsgT>(status_optional_detail::InPlaceError(), msg);
+    }
+
+    static constexpr StatusOptional<T&, MsgT> error(MsgT && msg STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<T&, MsgT>(status_optional_detail::InPlaceError(), std::move(msg));
+    }
+
+    /*!
+     * \brief error_in_place build an error, constructing the message from args directly in the returned StatusOptional
+     */
+    template <typename... Args>
+    static constexpr StatusOptional<T&, MsgT> error_in_place(Args&&... args) {
+        STATUS_OPTIONAL_RECORD(StatusOptionalSite::unknown(), Error);
+        return StatusOptional<T&, MsgT>(status_optional_detail::InPlaceError(), std::forward<Args>(args)...);
+    }
+
+    /*!
+     * \brief error_from build an error whose message is returned by formatter, in a function kept out of line.
+     */
+    template <typename F>
+    STATUS_OPTIONAL_COLD static StatusOptional<T&, MsgT> error_from(F && formatter STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Error);
+        return StatusOptional<T&, MsgT>(status_optional_detail::InPlaceError(), status_optional_detail::invoke(std::forward<F>(formatter)));
+    }
+
+    /*!
+     * \brief warning_from build a warning whose message is returned by formatter, in a function kept out of line.
+     */
+    template <typename F>
+    STATUS_OPTIONAL_COLD static StatusOptional<T&, MsgT> warning_from(T& val, F && formatter STATUS_OPTIONAL_SITE_PARAM) {
+        STATUS_OPTIONAL_RECORD(site, Warning);
+        return StatusOptional<T&, MsgT>(status_optional_detail::InPlaceWarning(), val, status_optional_detail::invoke(std::forward<F>(formatter)));
+    }
+
+    constexpr StatusOptional() = default;
+
+    constexpr StatusOptional(T& val) :
+        Base(std::in_place, status_optional_detail::address_of(val))
+    {
+
+    }
+
+    StatusOptional(std::remove_const_t<T> && val) = delete;
+
+    /*!
+     * \brief Construct a StatusOptional referring to val, with no message
+     */
+    constexpr explicit StatusOptional(std::in_place_t, T& val) :
+        Base(std::in_place, status_optional_detail::address_of(val))
+    {
+
+    }
+
+    /*!
+     * \brief Convert other, referring to a U convertible to a T (e.g. a derived class, or a non const U), in the same state.
+     */
+    template <typename U, typename M,
+              std::enable_if_t<!(std::is_same_v<T, U> and std::is_same_v<MsgT, M>) and
+                               std::is_convertible_v<U*, T*> and
+                               std::is_constructible_v<MsgT, M const&>, bool> = true>
+    StatusOptional(StatusOptional<U&, M> const& other) :
+        Base()
+    {
+        this->construct_from(static_cast<typename StatusOptional<U&, M>::Base const&>(other));
+    }
+
+    constexpr operator bool() const{
+        return has_value();
+    }
+
+    constexpr bool has_value() const {
+        return this->flags() & status_optional_detail::ValueFlag;
+    }
+
+    constexpr T& value() const {
+        if (!has_value()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return *this->_value._payload;
+    }
+
+    /*!
+     * \brief operator* access the value without checking that there is one, which is only asserted when STATUS_OPTIONAL_DEBUG is defined.
+     */
+    constexpr T& operator*() const {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return *this->_value._payload;
+    }
+
+    constexpr T* operator ->() const {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return this->_value._payload;
+    }
+
+    /*!
+     * \brief unchecked_value access the value without checking that there is one, as operator* does.
+     */
+    constexpr T& unchecked_value() const {
+        STATUS_OPTIONAL_ASSERT(has_value());
+        return *this->_value._payload;
+    }
+
+    /*!
+     * \brief value_or return a copy of the value, or alt converted to T if there is no value
+     */
+    template <typename U = std::remove_cv_t<T>>
+    constexpr std::remove_cv_t<T> value_or(U && alt) const {
+        if (has_value()) {
+            return *this->_value._payload;
+        }
+        return static_cast<std::remove_cv_t<T>>(std::forward<U>(alt));
+    }
+
+    /*!
+     * \brief value_or_else return a copy of the value, or the result of f() if there is no value
+     */
+    template <typename F>
+    constexpr std::remove_cv_t<T> value_or_else(F && f) const {
+        if (has_value()) {
+            return *this->_value._payload;
+        }
+        return static_cast<std::remove_cv_t<T>>(std::forward<F>(f)());
+    }
+
+    constexpr bool has_message() const {
+        return this->flags() & status_optional_detail::MessageFlag;
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type& message() {
+        if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type const& message() const {
+        if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    /*!
+     * \brief unchecked_message access the message without checking that there is one, which is only asserted when STATUS_OPTIONAL_DEBUG is defined.
+     */
+    constexpr typename status_message_traits<MsgT>::value_type& unchecked_message() {
+        STATUS_OPTIONAL_ASSERT(has_message());
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    constexpr typename status_message_traits<MsgT>::value_type const& unchecked_message() const {
+        STATUS_OPTIONAL_ASSERT(has_message());
+        return status_message_traits<MsgT>::get(this->_message._payload);
+    }
+
+    constexpr bool is_valid() const {
+        return this->flags() != status_optional_detail::NoFlag;
+    }
+
+    constexpr bool is_no_error_or_warning() const {
+        return this->flags() == status_optional_detail::ValueFlag;
+    }
+
+    constexpr bool is_warning() const {
+        return this->flags() == (status_optional_detail::ValueFlag | status_optional_detail::MessageFlag);
+    }
+
+    constexpr bool is_error() const {
+        return this->flags() == status_optional_detail::MessageFlag;
+    }
+
+    constexpr StatusOptionalState state() const {
+        return static_cast<StatusOptionalState>(this->flags());
+    }
+
+    /*!
+     * \brief visit call the function matching the state of the StatusOptional, and return its result, the value is passed as a T&.
+     */
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) & {
+        return status_optional_detail::Access::visit(*this, std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) const& {
+        return status_optional_detail::Access::visit(*this, std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    template <typename OnOk, typename OnWarning, typename OnError, typename OnInvalid>
+    auto visit(OnOk && onOk, OnWarning && onWarning, OnError && onError, OnInvalid && onInvalid) && {
+        return status_optional_detail::Access::visit(std::move(*this), std::forward<OnOk>(onOk), std::forward<OnWarning>(onWarning),
+                                                     std::forward<OnError>(onError), std::forward<OnInvalid>(onInvalid));
+    }
+
+    /*!
+     * \brief and_then call f with the value, as a T&, and return the StatusOptional returned by f
+     */
+    template <typename F>
+    auto and_then(F && f) & {
+        return status_optional_detail::Access::and_then(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto and_then(F && f) const& {
+        return status_optional_detail::Access::and_then(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto and_then(F && f) && {
+        return status_optional_detail::Access::and_then(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief transform call f with the value, as a T&, and return its result wrapped in a StatusOptional<U, MsgT>
+     */
+    template <typename F>
+    auto transform(F && f) & {
+        return status_optional_detail::Access::transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform(F && f) const& {
+        return status_optional_detail::Access::transform(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform(F && f) && {
+        return status_optional_detail::Access::transform(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief or_else call f with the message of an error, and return the StatusOptional<T&, MsgT> returned by f
+     */
+    template <typename F>
+    auto or_else(F && f) & {
+        return status_optional_detail::Access::or_else(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto or_else(F && f) const& {
+        return status_optional_detail::Access::or_else(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto or_else(F && f) && {
+        return status_optional_detail::Access::or_else(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief transform_error convert the message of a warning or an error using f, the result refers to the same value.
+     */
+    template <typename F>
+    auto transform_error(F && f) & {
+        return status_optional_detail::Access::transform_error(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform_error(F && f) const& {
+        return status_optional_detail::Access::transform_error(*this, std::forward<F>(f));
+    }
+
+    template <typename F>
+    auto transform_error(F && f) && {
+        return status_optional_detail::Access::transform_error(std::move(*this), std::forward<F>(f));
+    }
+
+    /*!
+     * \brief propagate_error move the error (or invalid state) of *this to a StatusOptional<U, MsgT>.
+     *
+     * *this must not hold a value: a value or a warning throws std::bad_optional_access, as value() does, rather than
+     * turning the warning into an error.
+     */
+    template <typename U>
+    StatusOptional<U, MsgT> propagate_error() && {
+        if (has_value()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return status_optional_detail::Access::failure_from<StatusOptional<U, MsgT>>(std::move(*this));
+    }
+};
+
+#endif // STATUS_OPTIONAL_CORE_H
@@ -0,0 +1,188 @@
+#ifndef STATUS_OPTIONAL_COROUTINE_H
+#define STATUS_OPTIONAL_COROUTINE_H
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "./status_optional.h"
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+
+/*!
+ * \file status_optional_coroutine.h
+ *
+ * Including this header lets functions returning a StatusOptional<T, MsgT> be written as coroutines,
+ * where co_await on a StatusOptional with the same message type returns its error (or its invalid state)
+ * from the function, or resumes with its value (nothing for StatusOptional<void, MsgT>). A warning resumes, and its message is dropped:
+ * a coroutine keeping it tests is_warning() before the co_await.
+ * co_return takes anything a StatusOptional<T, MsgT> can be built from.
+ *
+ * The promise has no return_void, so a StatusOptional<void, MsgT> coroutine must end with an explicit co_return,
+ * e.g. co_return StatusOptional<void, MsgT>(); flowing off its end is undefined behavior
+ * (in practice the conversion of its result then aborts as described in CoroutineReturn).
+ *
+ * \code
+ * StatusOptional<int, std::string> area(std::string_view w, std::string_view h) {
+ *     int width = co_await parse_int(w);
+ *     int height = co_await parse_int(h);
+ *     co_return width * height;
+ * }
+ * \endcode
+ *
+ * Such coroutines never suspend: they run to completion, or are destroyed at the first failed co_await.
+ */
+
+namespace status_optional_detail {
+
+template <typename SO>
+struct CoroutinePromise;
+
+/*!
+ * \brief The CoroutineReturn class is the object returned by get_return_object, converted to the StatusOptional returned by the coroutine.
+ *
+ * The result of the coroutine is stored in the CoroutineReturn until the conversion. The compilers converting it once the
+ * coroutine has completed (GCC, Clang 17 and later) are supported. A compiler converting it before the body runs leaves
+ * no object the result could be written to, as the StatusOptional may be returned in registers,
+ * so the conversion aborts with a message in that case rather than returning a result which is not known yet.
+ */
+template <typename SO>
+class CoroutineReturn {
+public:
+
+    explicit CoroutineReturn(CoroutinePromise<SO> & promise) :
+        _promise(&promise)
+    {
+        promise._return = this;
+    }
+
+    CoroutineReturn(CoroutineReturn && other) :
+        _storage(std::move(other._storage)),
+        _promise(other._promise)
+    {
+        other._promise = nullptr;
+        if (_promise != nullptr) {
+            _promise->_return = this;
+        }
+    }
+
+    CoroutineReturn(CoroutineReturn const&) = delete;
+
+    ~CoroutineReturn() {
+        if (_promise != nullptr) {
+            _promise->_return = nullptr;
+        }
+    }
+
+    operator SO() {
+        if (!_storage.has_value()) STATUS_OPTIONAL_UNLIKELY {
+            usage_error("a StatusOptional coroutine was converted to its result before completing, which this compiler is not supported for, or ended without co_return");
+        }
+        return std::move(*_storage);
+    }
+
+protected:
+
+    friend struct CoroutinePromise<SO>;
+
+    std::optional<SO> _storage;
+    CoroutinePromise<SO>* _promise;
+};
+
+template <typename SO, typename Awaited>
+struct CoroutineAwaiter {
+
+    bool await_ready() const noexcept {
+        return Access::succeeded(_awaited);
+    }
+
+    void await_suspend(std::coroutine_handle<CoroutinePromise<SO>> handle) {
+        handle.promise().set_result(Access::failure_from<SO>(std::forward<Awaited>(_awaited)));
+        handle.destroy();
+    }
+
+    decltype(auto) await_resume() {
+        using Value = typename remove_cvref_t<Awaited>::ValueType;
+        if constexpr (std::is_void_v<Value>) {
+            return;
+        } else if constexpr (std::is_lvalue_reference_v<Awaited>) {
+            return Access::stored_value(_awaited);
+        } else {
+            return Value(Access::stored_value(std::forward<Awaited>(_awaited)));
+        }
+    }
+
+    Awaited && _awaited;
+};
+
+template <typename SO>
+struct CoroutinePromise {
+
+    using MsgT = typename SO::MessageType;
+
+    CoroutinePromise() :
+        _return(nullptr)
+    {
+
+    }
+
+    ~CoroutinePromise() {
+        if (_return != nullptr) {
+            _return->_promise = nullptr;
+        }
+    }
+
+    CoroutineReturn<SO> get_return_object() {
+        return CoroutineReturn<SO>(*this);
+    }
+
+    std::suspend_never initial_suspend() noexcept {
+        return {};
+    }
+
+    std::suspend_never final_suspend() noexcept {
+        return {};
+    }
+
+    void unhandled_exception() {
+        rethrow_current_exception();
+    }
+
+    void return_value(SO && result) {
+        set_result(std::move(result));
+    }
+
+    template <typename U,
+              std::enable_if_t<!std::is_same_v<remove_cvref_t<U>, SO>, bool> = true>
+    void return_value(U && val) {
+        set_result(SO(std::forward<U>(val)));
+    }
+
+    template <typename Awaited,
+              std::enable_if_t<is_status_optional<remove_cvref_t<Awaited>>::value, bool> = true>
+    CoroutineAwaiter<SO, Awaited> await_transform(Awaited && awaited) {
+        static_assert(std::is_same_v<typename remove_cvref_t<Awaited>::MessageType, MsgT>, "co_await expects a StatusOptional with the same message type as the coroutine");
+        return CoroutineAwaiter<SO, Awaited>{std::forward<Awaited>(awaited)};
+    }
+
+    void set_result(SO && result) {
+        if (_return != nullptr) {
+            _return->_storage.emplace(std::move(result));
+        }
+    }
+
+    CoroutineReturn<SO>* _return;
+};
+
+} // namespace status_optional_detail
+
+template <typename T, typename MsgT, typename... Args>
+struct std::coroutine_traits<StatusOptional<T, MsgT>, Args...> {
+    using promise_type = status_optional_detail::CoroutinePromise<StatusOptional<T, MsgT>>;
+};
+
+#endif
+
+#endif // STATUS_OPTIONAL_COROUTINE_H
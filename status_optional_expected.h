@@ -0,0 +1,263 @@
+#ifndef STATUS_OPTIONAL_EXPECTED_H
+#define STATUS_OPTIONAL_EXPECTED_H
+
+#include <type_traits>
+#include <utility>
+
+#include "./status_optional.h"
+
+#if __has_include(<expected>)
+#include <expected>
+#endif
+
+#if defined(__cpp_lib_expected)
+
+/*!
+ * \file status_optional_expected.h
+ *
+ * Conversions between StatusOptional<T, MsgT> and std::expected<T, MsgT>, available when the standard library provides std::expected (C++23).
+ * The conversions move the payloads once when converting an rvalue: the value to the value and the message to the error.
+ *
+ * std::expected has no warning state, so to_expected takes an ExpectedWarning policy telling what a warning becomes.
+ *
+ * The free functions and_then, transform, or_else and transform_error accept either type, so generic code can chain
+ * the operations on a result without knowing which of the two it gets. They call the member function of the same name,
+ * or implement it when the standard library provides std::expected without its monadic operations.
+ */
+
+/*!
+ * \brief The ExpectedWarning enum is the policy of to_expected for the warnings.
+ */
+enum class ExpectedWarning {
+    DropMessage, //!< the warning becomes a value, the message is dropped.
+    AsError //!< the warning becomes an error, the value is dropped.
+};
+
+namespace status_optional_detail {
+
+template <typename T>
+struct is_expected : std::false_type {};
+
+template <typename T, typename E>
+struct is_expected<std::expected<T, E>> : std::true_type {};
+
+template <typename R>
+constexpr bool is_result_v = is_status_optional<remove_cvref_t<R>>::value or is_expected<remove_cvref_t<R>>::value;
+
+template <typename Self>
+auto to_expected(Self && self, ExpectedWarning policy) {
+    using SO = remove_cvref_t<Self>;
+    using T = typename SO::ValueType;
+    using MsgT = typename SO::MessageType;
+    using Ret = std::expected<T, MsgT>;
+
+    if (Access::succeeded(self) and (policy == ExpectedWarning::DropMessage or !self.has_message())) {
+        if constexpr (std::is_void_v<T>) {
+            return Ret();
+        } else {
+            return Ret(std::in_place, Access::stored_value(std::forward<Self>(self)));
+        }
+    }
+    if (self.has_message()) {
+        return Ret(std::unexpect, Access::stored_message(std::forward<Self>(self)));
+    }
+    if constexpr (std::is_default_constructible_v<MsgT>) {
+        return Ret(std::unexpect);
+    } else {
+        throw_bad_optional_access();
+    }
+}
+
+template <typename Exp>
+auto from_expected(Exp && exp) {
+    using T = typename remove_cvref_t<Exp>::value_type;
+    using MsgT = typename remove_cvref_t<Exp>::error_type;
+    using Ret = StatusOptional<T, MsgT>;
+
+    if (!exp.has_value()) STATUS_OPTIONAL_UNLIKELY {
+        return Ret::error_in_place(std::forward<Exp>(exp).error());
+    }
+    if constexpr (std::is_void_v<T>) {
+        return Ret();
+    } else {
+        return Ret(std::in_place, *std::forward<Exp>(exp));
+    }
+}
+
+/*!
+ * \brief The ExpectedOps struct implements the monadic operations of std::expected, for the standard libraries providing std::expected without them.
+ */
+struct ExpectedOps {
+
+    template <typename Exp, typename F>
+    static auto and_then(Exp && exp, F && f) {
+        using T = typename remove_cvref_t<Exp>::value_type;
+        if constexpr (std::is_void_v<T>) {
+            using Ret = remove_cvref_t<std::invoke_result_t<F>>;
+            if (exp.has_value()) {
+                return status_optional_detail::invoke(std::forward<F>(f));
+            }
+            return Ret(std::unexpect, std::forward<Exp>(exp).error());
+        } else {
+            using Ret = remove_cvref_t<std::invoke_result_t<F, decltype(*std::declval<Exp>())>>;
+            if (exp.has_value()) {
+                return status_optional_detail::invoke(std::forward<F>(f), *std::forward<Exp>(exp));
+            }
+            return Ret(std::unexpect, std::forward<Exp>(exp).error());
+        }
+    }
+
+    template <typename Exp, typename F>
+    static auto transform(Exp && exp, F && f) {
+        using T = typename remove_cvref_t<Exp>::value_type;
+        using E = typename remove_cvref_t<Exp>::error_type;
+        if constexpr (std::is_void_v<T>) {
+            using U = remove_cvref_t<std::invoke_result_t<F>>;
+            using Ret = std::expected<U, E>;
+            if (!exp.has_value()) {
+                return Ret(std::unexpect, std::forward<Exp>(exp).error());
+            }
+            if constexpr (std::is_void_v<U>) {
+                status_optional_detail::invoke(std::forward<F>(f));
+                return Ret();
+            } else {
+                return Ret(std::in_place, status_optional_detail::invoke(std::forward<F>(f)));
+            }
+        } else {
+            using U = remove_cvref_t<std::invoke_result_t<F, decltype(*std::declval<Exp>())>>;
+            using Ret = std::expected<U, E>;
+            if (!exp.has_value()) {
+                return Ret(std::unexpect, std::forward<Exp>(exp).error());
+            }
+            if constexpr (std::is_void_v<U>) {
+                status_optional_detail::invoke(std::forward<F>(f), *std::forward<Exp>(exp));
+                return Ret();
+            } else {
+                return Ret(std::in_place, status_optional_detail::invoke(std::forward<F>(f), *std::forward<Exp>(exp)));
+            }
+        }
+    }
+
+    template <typename Exp, typename F>
+    static auto or_else(Exp && exp, F && f) {
+        using T = typename remove_cvref_t<Exp>::value_type;
+        using Ret = remove_cvref_t<std::invoke_result_t<F, decltype(std::declval<Exp>().error())>>;
+        if (exp.has_value()) {
+            if constexpr (std::is_void_v<T>) {
+                return Ret();
+            } else {
+                return Ret(std::in_place, *std::forward<Exp>(exp));
+            }
+        }
+        return status_optional_detail::invoke(std::forward<F>(f), std::forward<Exp>(exp).error());
+    }
+
+    template <typename Exp, typename F>
+    static auto transform_error(Exp && exp, F && f) {
+        using T = typename remove_cvref_t<Exp>::value_type;
+        using G = remove_cvref_t<std::invoke_result_t<F, decltype(std::declval<Exp>().error())>>;
+        using Ret = std::expected<T, G>;
+        if (exp.has_value()) {
+            if constexpr (std::is_void_v<T>) {
+                return Ret();
+            } else {
+                return Ret(std::in_place, *std::forward<Exp>(exp));
+            }
+        }
+        return Ret(std::unexpect, status_optional_detail::invoke(std::forward<F>(f), std::forward<Exp>(exp).error()));
+    }
+};
+
+/*!
+ * \brief has_monadic_members_v tells if the operations can be called as member functions of R, always true for a StatusOptional.
+ */
+template <typename R>
+constexpr bool has_monadic_members_v = is_status_optional<remove_cvref_t<R>>::value or __cpp_lib_expected >= 202211L;
+
+} // namespace status_optional_detail
+
+/*!
+ * \brief to_expected convert result to a std::expected<T, MsgT>, moving the payloads if result is an rvalue
+ * \param policy what a warning becomes
+ *
+ * An invalid StatusOptional becomes an error with a value initialized message,
+ * or throws std::bad_optional_access if MsgT is not default constructible.
+ */
+template <typename T, typename MsgT>
+std::expected<T, MsgT> to_expected(StatusOptional<T, MsgT> const& result, ExpectedWarning policy) {
+    return status_optional_detail::to_expected(result, policy);
+}
+
+template <typename T, typename MsgT>
+std::expected<T, MsgT> to_expected(StatusOptional<T, MsgT> && result, ExpectedWarning policy) {
+    return status_optional_detail::to_expected(std::move(result), policy);
+}
+
+/*!
+ * \brief to_status_optional convert result to a StatusOptional<T, E>, a value or an error, moving the payloads if result is an rvalue
+ */
+template <typename T, typename E>
+StatusOptional<T, E> to_status_optional(std::expected<T, E> const& result) {
+    return status_optional_detail::from_expected(result);
+}
+
+template <typename T, typename E>
+StatusOptional<T, E> to_status_optional(std::expected<T, E> && result) {
+    return status_optional_detail::from_expected(std::move(result));
+}
+
+/*!
+ * \brief and_then call result.and_then(f), result being a StatusOptional or a std::expected
+ */
+template <typename R, typename F,
+          std::enable_if_t<status_optional_detail::is_result_v<R>, bool> = true>
+auto and_then(R && result, F && f) {
+    if constexpr (status_optional_detail::has_monadic_members_v<R>) {
+        return std::forward<R>(result).and_then(std::forward<F>(f));
+    } else {
+        return status_optional_detail::ExpectedOps::and_then(std::forward<R>(result), std::forward<F>(f));
+    }
+}
+
+/*!
+ * \brief transform call result.transform(f), result being a StatusOptional or a std::expected
+ */
+template <typename R, typename F,
+          std::enable_if_t<status_optional_detail::is_result_v<R>, bool> = true>
+auto transform(R && result, F && f) {
+    if constexpr (status_optional_detail::has_monadic_members_v<R>) {
+        return std::forward<R>(result).transform(std::forward<F>(f));
+    } else {
+        return status_optional_detail::ExpectedOps::transform(std::forward<R>(result), std::forward<F>(f));
+    }
+}
+
+/*!
+ * \brief or_else call result.or_else(f), result being a StatusOptional or a std::expected
+ */
+template <typename R, typename F,
+          std::enable_if_t<status_optional_detail::is_result_v<R>, bool> = true>
+auto or_else(R && result, F && f) {
+    if constexpr (status_optional_detail::has_monadic_members_v<R>) {
+        return std::forward<R>(result).or_else(std::forward<F>(f));
+    } else {
+        return status_optional_detail::ExpectedOps::or_else(std::forward<R>(result), std::forward<F>(f));
+    }
+}
+
+/*!
+ * \brief transform_error call result.transform_error(f), result being a StatusOptional or a std::expected
+ */
+template <typename R, typename F,
+          std::enable_if_t<status_optional_detail::is_result_v<R>, bool> = true>
+auto transform_error(R && result, F && f) {
+    if constexpr (status_optional_detail::has_monadic_members_v<R>) {
+        return std::forward<R>(result).transform_error(std::forward<F>(f));
+    } else {
+        return status_optional_detail::ExpectedOps::transform_error(std::forward<R>(result), std::forward<F>(f));
+    }
+}
+
+#endif
+
+#endif // STATUS_OPTIONAL_EXPECTED_H
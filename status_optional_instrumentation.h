@@ -0,0 +1,237 @@
+#ifndef STATUS_OPTIONAL_INSTRUMENTATION_H
+#define STATUS_OPTIONAL_INSTRUMENTATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if __has_include(<source_location>)
+#include <source_location>
+#endif
+
+/*!
+ * \file status_optional_instrumentation.h
+ *
+ * Defining STATUS_OPTIONAL_INSTRUMENTATION before including status_optional.h makes the warning and error factories
+ * report their call site to a hook, which by default counts the warnings and errors created at each site.
+ * Without the macro, this header is not included and the factories are unchanged.
+ *
+ * The factories taking a variable number of arguments (the in place and allocator aware ones) can not capture
+ * their call site, they are reported with an empty site. The value constructors are never instrumented.
+ */
+
+#ifndef STATUS_OPTIONAL_INSTRUMENTATION_SITES
+/*!
+ * \brief STATUS_OPTIONAL_INSTRUMENTATION_SITES is the number of call sites the default hook can count, the others are ignored.
+ */
+#define STATUS_OPTIONAL_INSTRUMENTATION_SITES 4096
+#endif
+
+/*!
+ * \brief The StatusOptionalSite struct is the location of a call to a warning or error factory.
+ */
+struct StatusOptionalSite {
+
+    char const* file;
+    char const* function;
+    std::uint_least32_t line;
+
+#if defined(__cpp_lib_source_location)
+    static constexpr StatusOptionalSite current(std::source_location location = std::source_location::current()) noexcept {
+        return StatusOptionalSite{location.file_name(), location.function_name(), location.line()};
+    }
+#else
+    static constexpr StatusOptionalSite current(char const* file = __builtin_FILE(),
+                                                char const* function = __builtin_FUNCTION(),
+                                                std::uint_least32_t line = __builtin_LINE()) noexcept {
+        return StatusOptionalSite{file, function, line};
+    }
+#endif
+
+    static constexpr StatusOptionalSite unknown() noexcept {
+        return StatusOptionalSite{"", "", 0};
+    }
+};
+
+enum class StatusOptionalEvent : std::uint8_t {
+    Warning,
+    Error
+};
+
+/*!
+ * \brief The StatusOptionalSiteCount struct is the number of warnings and errors created at a site, as counted by the default hook.
+ */
+struct StatusOptionalSiteCount {
+    StatusOptionalSite site;
+    std::uint64_t warnings;
+    std::uint64_t errors;
+};
+
+/*!
+ * \brief StatusOptionalHook is the function called with the site and the kind of each warning and error created.
+ *
+ * error_in_place, warning_in_place (except the piecewise one of StatusOptional<T>) and the factories taking std::allocator_arg
+ * forward a variable number of arguments, after which no defaulted site parameter can be added: the hook is still called
+ * for them, with StatusOptionalSite::unknown() (empty file and function, line 0). A caller needing the site of these
+ * errors and warnings builds the message first and calls error or warning, which capture it.
+ */
+using StatusOptionalHook = void (*)(StatusOptionalSite const& site, StatusOptionalEvent event);
+
+namespace status_optional_detail {
+
+/*!
+ * \brief The SiteTable class is the open addressing hash table of counters used by the default hook.
+ *
+ * A site is inserted once, by claiming an entry with a compare and swap, and is never removed.
+ * Counting only takes relaxed atomic increments, and reading the table never blocks the threads counting.
+ */
+class SiteTable {
+public:
+
+    void count(StatusOptionalSite const& site, StatusOptionalEvent event) noexcept {
+        Entry* entry = find_or_insert(site);
+        if (entry == nullptr) {
+            return;
+        }
+        std::atomic<std::uint64_t> & counter = (event == StatusOptionalEvent::Warning) ? entry->warnings : entry->errors;
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<StatusOptionalSiteCount> snapshot() const {
+        std::vector<StatusOptionalSiteCount> ret;
+        for (Entry const& entry : _entries) {
+            if (entry.state.load(std::memory_order_acquire) != Ready) {
+                continue;
+            }
+            ret.push_back(StatusOptionalSiteCount{entry.site,
+                                                  entry.warnings.load(std::memory_order_relaxed),
+                                                  entry.errors.load(std::memory_order_relaxed)});
+        }
+        return ret;
+    }
+
+    void reset() noexcept {
+        for (Entry & entry : _entries) {
+            entry.warnings.store(0, std::memory_order_relaxed);
+            entry.errors.store(0, std::memory_order_relaxed);
+        }
+    }
+
+protected:
+
+    static constexpr std::uint8_t Empty = 0;
+    static constexpr std::uint8_t Writing = 1;
+    static constexpr std::uint8_t Ready = 2;
+
+    struct Entry {
+        std::atomic<std::uint8_t> state{Empty};
+        StatusOptionalSite site{"", "", 0};
+        std::atomic<std::uint64_t> warnings{0};
+        std::atomic<std::uint64_t> errors{0};
+    };
+
+    static constexpr std::size_t Capacity = STATUS_OPTIONAL_INSTRUMENTATION_SITES;
+
+    static bool same_site(StatusOptionalSite const& a, StatusOptionalSite const& b) noexcept {
+        return a.line == b.line and (a.file == b.file or std::strcmp(a.file, b.file) == 0) and
+               (a.function == b.function or std::strcmp(a.function, b.function) == 0);
+    }
+
+    static std::size_t hash(StatusOptionalSite const& site) noexcept {
+        std::uint64_t h = 14695981039346656037ull;
+        for (char const* c = site.file; *c != '\0'; c++) {
+            h = (h ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+        }
+        return static_cast<std::size_t>((h ^ site.line) * 1099511628211ull);
+    }
+
+    Entry* find_or_insert(StatusOptionalSite const& site) noexcept {
+        std::size_t start = hash(site) % Capacity;
+        for (std::size_t probe = 0; probe < Capacity; probe++) {
+            Entry & entry = _entries[(start + probe) % Capacity];
+            std::uint8_t state = entry.state.load(std::memory_order_acquire);
+            if (state == Empty) {
+                if (entry.state.compare_exchange_strong(state, Writing, std::memory_order_acquire)) {
+                    entry.site = site;
+                    entry.state.store(Ready, std::memory_order_release);
+                    return &entry;
+                }
+            }
+            while (state == Writing) {
+                state = entry.state.load(std::memory_order_acquire);
+            }
+            if (same_site(entry.site, site)) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    Entry _entries[Capacity];
+};
+
+inline SiteTable siteTable;
+
+inline void count_site(StatusOptionalSite const& site, StatusOptionalEvent event) noexcept {
+    siteTable.count(site, event);
+}
+
+inline std::atomic<StatusOptionalHook> currentHook{&count_site};
+
+/*!
+ * \brief record_site call the hook, except during constant evaluation.
+ */
+constexpr void record_site(StatusOptionalSite const& site, StatusOptionalEvent event) {
+#if defined(__cpp_lib_is_constant_evaluated)
+    if (std::is_constant_evaluated()) {
+        return;
+    }
+#else
+    if (__builtin_is_constant_evaluated()) {
+        return;
+    }
+#endif
+    StatusOptionalHook hook = currentHook.load(std::memory_order_relaxed);
+    if (hook != nullptr) {
+        hook(site, event);
+    }
+}
+
+} // namespace status_optional_detail
+
+/*!
+ * \brief status_optional_set_hook replace the function called for each warning and error created, and return the previous one.
+ *
+ * The hook can be called concurrently from any thread. nullptr disables the instrumentation.
+ */
+inline StatusOptionalHook status_optional_set_hook(StatusOptionalHook hook) noexcept {
+    return status_optional_detail::currentHook.exchange(hook);
+}
+
+/*!
+ * \brief status_optional_default_hook is the hook counting the warnings and errors of each site, installed by default.
+ */
+inline StatusOptionalHook status_optional_default_hook() noexcept {
+    return &status_optional_detail::count_site;
+}
+
+/*!
+ * \brief status_optional_site_counts return a snapshot of the counters of the default hook, for each site seen so far.
+ *
+ * The counters of different sites are read independently, while other threads may still be counting.
+ */
+inline std::vector<StatusOptionalSiteCount> status_optional_site_counts() {
+    return status_optional_detail::siteTable.snapshot();
+}
+
+/*!
+ * \brief status_optional_reset_site_counts set the counters of the default hook back to zero, the sites seen are kept.
+ */
+inline void status_optional_reset_site_counts() noexcept {
+    status_optional_detail::siteTable.reset();
+}
+
+#endif // STATUS_OPTIONAL_INSTRUMENTATION_H
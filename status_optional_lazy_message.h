@@ -0,0 +1,213 @@
+#ifndef STATUS_OPTIONAL_LAZY_MESSAGE_H
+#define STATUS_OPTIONAL_LAZY_MESSAGE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "./status_optional.h"
+
+/*!
+ * \brief The LazyMessage class is a message type which can defer building its message until it is read.
+ *
+ * A LazyMessage<MsgT> is either a MsgT, or a small function object returning a MsgT
+ * (typically a lambda capturing the formatting arguments). The function object is stored inline,
+ * in a buffer of BufferSize bytes, and is only called the first time the message is read.
+ *
+ * status_message_traits is specialized so that StatusOptional<T, LazyMessage<MsgT>>::message() returns the MsgT,
+ * a warning whose message is never read never pays for its formatting:
+ *
+ * \code
+ * return StatusOptional<T, LazyMessage<>>::warning(val, [offset] () { return "Padding at " + std::to_string(offset); });
+ * \endcode
+ *
+ * Reading the message of a const LazyMessage builds it as well, so a LazyMessage shared between threads
+ * must be read once before being accessed concurrently.
+ */
+template <typename MsgT = std::string, std::size_t BufferSize = 3*sizeof(void*)>
+class LazyMessage {
+public:
+
+    typedef MsgT MessageType;
+
+    template <typename U,
+              std::enable_if_t<!std::is_same_v<std::decay_t<U>, LazyMessage> and
+                               std::is_constructible_v<MsgT, U&&> and
+                               !std::is_invocable_v<std::decay_t<U>&>, bool> = true>
+    LazyMessage(U && msg) :
+        _ops(nullptr)
+    {
+        ::new (static_cast<void*>(&_msg)) MsgT(std::forward<U>(msg));
+    }
+
+    /*!
+     * \brief Construct a LazyMessage which will build its message by calling formatter
+     */
+    template <typename F,
+              std::enable_if_t<!std::is_same_v<std::decay_t<F>, LazyMessage> and
+                               std::is_invocable_r_v<MsgT, std::decay_t<F>&>, bool> = true>
+    LazyMessage(F && formatter) :
+        _ops(&FormatterOps<std::decay_t<F>>::ops)
+    {
+        using Formatter = std::decay_t<F>;
+        static_assert(sizeof(Formatter) <= BufferSize, "The formatter does not fit in the LazyMessage buffer, capture less or increase BufferSize");
+        static_assert(alignof(Formatter) <= alignof(void*), "The formatter is over aligned for the LazyMessage buffer");
+        static_assert(std::is_nothrow_move_constructible_v<Formatter>, "The formatter must be nothrow move constructible");
+        ::new (static_cast<void*>(_buffer)) Formatter(std::forward<F>(formatter));
+    }
+
+    LazyMessage(LazyMessage const& other) :
+        _ops(nullptr)
+    {
+        if (other._ops != nullptr and other._ops->copy == nullptr) {
+            other.get();
+        }
+        construct_from(other);
+    }
+
+    LazyMessage(LazyMessage && other) noexcept(std::is_nothrow_move_constructible_v<MsgT>) :
+        _ops(nullptr)
+    {
+        construct_from(std::move(other));
+    }
+
+    ~LazyMessage() {
+        destroy();
+    }
+
+    LazyMessage& operator=(LazyMessage const& other) {
+        if (this != &other) {
+            LazyMessage copy(other);
+            destroy();
+            construct_from(std::move(copy));
+        }
+        return *this;
+    }
+
+    LazyMessage& operator=(LazyMessage && other) noexcept(std::is_nothrow_move_constructible_v<MsgT>) {
+        if (this != &other) {
+            destroy();
+            construct_from(std::move(other));
+        }
+        return *this;
+    }
+
+    /*!
+     * \brief is_resolved indicate if the message has already been built
+     */
+    bool is_resolved() const {
+        return _ops == nullptr;
+    }
+
+    /*!
+     * \brief get build the message if needed, and return it
+     */
+    MsgT& get() {
+        resolve();
+        return _msg;
+    }
+
+    MsgT const& get() const {
+        resolve();
+        return _msg;
+    }
+
+protected:
+
+    struct Ops {
+        MsgT (*format)(void* formatter);
+        void (*copy)(void* dst, void const* src);
+        void (*move)(void* dst, void* src) noexcept;
+        void (*destroy)(void* formatter) noexcept;
+    };
+
+    template <typename Formatter>
+    struct FormatterOps {
+
+        static MsgT format(void* formatter) {
+            return (*static_cast<Formatter*>(formatter))();
+        }
+
+        static void copy(void* dst, void const* src) {
+            ::new (dst) Formatter(*static_cast<Formatter const*>(src));
+        }
+
+        static void move(void* dst, void* src) noexcept {
+            ::new (dst) Formatter(std::move(*static_cast<Formatter*>(src)));
+        }
+
+        static void destroy(void* formatter) noexcept {
+            static_cast<Formatter*>(formatter)->~Formatter();
+        }
+
+        static constexpr void (*copy_function())(void*, void const*) {
+            if constexpr (std::is_copy_constructible_v<Formatter>) {
+                return &copy;
+            } else {
+                return nullptr;
+            }
+        }
+
+        static constexpr Ops ops = {
+            &format,
+            copy_function(),
+            &move,
+            &destroy
+        };
+    };
+
+    void resolve() const {
+        if (_ops == nullptr) {
+            return;
+        }
+        MsgT msg = _ops->format(_buffer);
+        _ops->destroy(_buffer);
+        _ops = nullptr;
+        ::new (static_cast<void*>(&_msg)) MsgT(std::move(msg));
+    }
+
+    /*!
+     * \brief construct_from copy or move the content of other, *this must have been destroyed.
+     */
+    template <typename Other>
+    void construct_from(Other && other) {
+        if (other._ops == nullptr) {
+            ::new (static_cast<void*>(&_msg)) MsgT(std::forward<Other>(other)._msg);
+        } else if constexpr (std::is_const_v<std::remove_reference_t<Other>>) {
+            other._ops->copy(_buffer, other._buffer);
+        } else {
+            other._ops->move(_buffer, other._buffer);
+        }
+        _ops = other._ops;
+    }
+
+    void destroy() {
+        if (_ops == nullptr) {
+            _msg.~MsgT();
+        } else {
+            _ops->destroy(_buffer);
+        }
+    }
+
+    union {
+        mutable MsgT _msg;
+        alignas(void*) mutable unsigned char _buffer[BufferSize];
+    };
+    mutable Ops const* _ops;
+};
+
+template <typename MsgT, std::size_t BufferSize>
+struct status_message_traits<LazyMessage<MsgT, BufferSize>> {
+    typedef MsgT value_type;
+
+    static MsgT& get(LazyMessage<MsgT, BufferSize> & msg) {
+        return msg.get();
+    }
+
+    static MsgT const& get(LazyMessage<MsgT, BufferSize> const& msg) {
+        return msg.get();
+    }
+};
+
+#endif // STATUS_OPTIONAL_LAZY_MESSAGE_H
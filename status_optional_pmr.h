@@ -0,0 +1,26 @@
+#ifndef STATUS_OPTIONAL_PMR_H
+#define STATUS_OPTIONAL_PMR_H
+
+#include <memory_resource>
+#include <string>
+
+#include "./status_optional.h"
+
+namespace pmr {
+
+/*!
+ * \brief pmr::StatusOptional is a StatusOptional whose default message type allocates from a std::pmr::memory_resource.
+ *
+ * Build warnings and errors with the std::allocator_arg_t overloads of the factories to allocate the messages
+ * from an arena (e.g. a std::pmr::monotonic_buffer_resource), which will then free them in bulk:
+ *
+ * \code
+ * pmr::StatusOptional<T>::error(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&arena), "Error");
+ * \endcode
+ */
+template <typename T, typename MsgT = std::pmr::string>
+using StatusOptional = ::StatusOptional<T, MsgT>;
+
+} // namespace pmr
+
+#endif // STATUS_OPTIONAL_PMR_H
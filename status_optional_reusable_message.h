@@ -0,0 +1,112 @@
+#ifndef STATUS_OPTIONAL_REUSABLE_MESSAGE_H
+#define STATUS_OPTIONAL_REUSABLE_MESSAGE_H
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "./status_optional.h"
+
+/*!
+ * \brief The ReusableMessage class is a message type keeping its buffer when the StatusOptional holding it drops it.
+ *
+ * A StatusOptional<T, ReusableMessage<MsgT>> reused across the iterations of a loop clears its message instead of destroying it
+ * (see status_message_reuse), and the next emplace_message, set_warning or set_error assigns the new text to the retained MsgT,
+ * so once the buffer is large enough the loop does not allocate anymore. MsgT needs a clear() member, as std::string has.
+ *
+ * A ReusableMessage is built implicitly from anything a MsgT can be built from, and assigning such a value assigns it to the MsgT.
+ * status_message_traits is specialized so that message() returns the MsgT.
+ */
+template <typename MsgT = std::string>
+class ReusableMessage {
+public:
+
+    typedef MsgT MessageType;
+
+    ReusableMessage() = default;
+
+    template <typename U,
+              std::enable_if_t<!std::is_same_v<std::decay_t<U>, ReusableMessage> and
+                               std::is_constructible_v<MsgT, U&&>, bool> = true>
+    ReusableMessage(U && msg) :
+        _msg(std::forward<U>(msg))
+    {
+
+    }
+
+    /*!
+     * \brief Construct a ReusableMessage holding a message built in place from args
+     */
+    template <typename... Args>
+    explicit ReusableMessage(std::in_place_t, Args&&... args) :
+        _msg(std::forward<Args>(args)...)
+    {
+
+    }
+
+    template <typename U,
+              std::enable_if_t<!std::is_same_v<std::decay_t<U>, ReusableMessage> and
+                               std::is_assignable_v<MsgT&, U&&>, bool> = true>
+    ReusableMessage& operator=(U && msg) {
+        _msg = std::forward<U>(msg);
+        return *this;
+    }
+
+    MsgT& get() {
+        return _msg;
+    }
+
+    MsgT const& get() const {
+        return _msg;
+    }
+
+    /*!
+     * \brief clear empty the message, keeping its buffer
+     */
+    void clear() {
+        _msg.clear();
+    }
+
+    friend bool operator==(ReusableMessage const& a, ReusableMessage const& b) {
+        return a._msg == b._msg;
+    }
+
+    friend bool operator!=(ReusableMessage const& a, ReusableMessage const& b) {
+        return !(a == b);
+    }
+
+protected:
+    MsgT _msg;
+};
+
+template <typename MsgT>
+struct status_message_traits<ReusableMessage<MsgT>> {
+    typedef MsgT value_type;
+
+    static MsgT& get(ReusableMessage<MsgT> & msg) noexcept {
+        return msg.get();
+    }
+
+    static MsgT const& get(ReusableMessage<MsgT> const& msg) noexcept {
+        return msg.get();
+    }
+};
+
+template <typename MsgT>
+struct status_message_merge<ReusableMessage<MsgT>> {
+    static void merge(ReusableMessage<MsgT> & into, ReusableMessage<MsgT> && from) {
+        status_message_merge<MsgT>::merge(into.get(), std::move(from.get()));
+    }
+};
+
+template <typename MsgT>
+struct status_message_reuse<ReusableMessage<MsgT>> {
+
+    static constexpr bool keep_capacity = true;
+
+    static void clear(ReusableMessage<MsgT> & msg) {
+        msg.clear();
+    }
+};
+
+#endif // STATUS_OPTIONAL_REUSABLE_MESSAGE_H
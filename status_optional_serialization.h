@@ -0,0 +1,596 @@
+#ifndef STATUS_OPTIONAL_SERIALIZATION_H
+#define STATUS_OPTIONAL_SERIALIZATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "./status_optional.h"
+#include "./status_optional_batch.h"
+
+/*!
+ * \file status_optional_serialization.h
+ *
+ * A compact binary encoding of StatusOptional<T, MsgT> and StatusOptionalBatch<T, MsgT>, to send results between processes.
+ *
+ * A StatusOptional is encoded as:
+ * - one byte, the StatusOptionalState of the result,
+ * - if it has a value, the value: exactly status_optional_codec<T>::fixed_size bytes for fixed size codecs,
+ *   and a length followed by the bytes of the value otherwise,
+ * - if it has a message, a length followed by the bytes of the message (the value returned by message()).
+ *
+ * Lengths are unsigned LEB128 varints, so a short message only costs one byte of length.
+ * The payloads are encoded by status_optional_codec, the customization point of this header.
+ *
+ * StatusOptionalView reads an encoded result in place, and only decodes the value or the message when it is accessed.
+ */
+
+/*!
+ * \brief status_optional_codec is the customization point encoding the payloads of a StatusOptional.
+ *
+ * A specialization needs available set to true, fixed_size (the size of every encoded value, or 0 for variable size encodings),
+ * a static size(v) giving the number of bytes of v, encode(v, out) writing these bytes,
+ * and decode(in, size) building back a value from them. A variable size codec can also declare
+ * `static bool accepts_size(std::size_t size)`, the encoded lengths it rejects making the input malformed.
+ *
+ * It is implemented for the arithmetic and enumeration types, copied byte by byte, and for std::basic_string of such characters.
+ * status_optional_trivial_codec implements it for any other trivially copyable type without pointers:
+ *
+ * \code
+ * template <> struct status_optional_codec<Point> : status_optional_trivial_codec<Point> {};
+ * \endcode
+ *
+ * The bytes copied are its representation in memory, so both processes must share the byte order and the layout of the type.
+ */
+template <typename T, typename = void>
+struct status_optional_codec {
+    static constexpr bool available = false;
+};
+
+template <typename T>
+struct status_optional_trivial_codec {
+    static_assert(std::is_trivially_copyable_v<T>, "status_optional_trivial_codec copies the bytes of the value, it must be trivially copyable");
+
+    static constexpr bool available = true;
+    static constexpr std::size_t fixed_size = sizeof(T);
+
+    static constexpr std::size_t size(T const&) noexcept {
+        return sizeof(T);
+    }
+
+    static void encode(T const& val, unsigned char* out) noexcept {
+        std::memcpy(out, &val, sizeof(T));
+    }
+
+    static T decode(unsigned char const* in, std::size_t) noexcept {
+        T ret;
+        std::memcpy(&ret, in, sizeof(T));
+        return ret;
+    }
+};
+
+template <typename T>
+struct status_optional_codec<T, std::enable_if_t<std::is_arithmetic_v<T> or std::is_enum_v<T>>> : status_optional_trivial_codec<T> {};
+
+template <typename CharT, typename Traits, typename Alloc>
+struct status_optional_codec<std::basic_string<CharT, Traits, Alloc>, std::enable_if_t<std::is_arithmetic_v<CharT>>> {
+    static constexpr bool available = true;
+    static constexpr std::size_t fixed_size = 0;
+
+    static std::size_t size(std::basic_string<CharT, Traits, Alloc> const& str) noexcept {
+        return str.size() * sizeof(CharT);
+    }
+
+    static void encode(std::basic_string<CharT, Traits, Alloc> const& str, unsigned char* out) noexcept {
+        if (!str.empty()) {
+            std::memcpy(out, str.data(), str.size() * sizeof(CharT));
+        }
+    }
+
+    /*!
+     * \brief accepts_size tell if size bytes can encode a string, which holds a whole number of characters.
+     */
+    static constexpr bool accepts_size(std::size_t size) noexcept {
+        return size % sizeof(CharT) == 0;
+    }
+
+    static std::basic_string<CharT, Traits, Alloc> decode(unsigned char const* in, std::size_t size) {
+        std::size_t length = size / sizeof(CharT);
+        std::basic_string<CharT, Traits, Alloc> ret(length, CharT());
+        if (length > 0) {
+            std::memcpy(&ret[0], in, length * sizeof(CharT));
+        }
+        return ret;
+    }
+};
+
+namespace status_optional_detail {
+
+template <typename T>
+using codec_for = status_optional_codec<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+template <typename MsgT>
+using message_codec_for = status_optional_codec<typename status_message_traits<MsgT>::value_type>;
+
+inline std::size_t varint_size(std::uint64_t val) noexcept {
+    std::size_t ret = 1;
+    while (val >= 0x80) {
+        val >>= 7;
+        ret++;
+    }
+    return ret;
+}
+
+inline unsigned char* write_varint(std::uint64_t val, unsigned char* out) noexcept {
+    while (val >= 0x80) {
+        *out++ = static_cast<unsigned char>(val | 0x80);
+        val >>= 7;
+    }
+    *out++ = static_cast<unsigned char>(val);
+    return out;
+}
+
+/*!
+ * \brief read_varint read a varint from [in, end), and return the position after it, or nullptr if it is truncated or too long.
+ */
+inline unsigned char const* read_varint(unsigned char const* in, unsigned char const* end, std::uint64_t & val) noexcept {
+    val = 0;
+    for (int shift = 0; shift < 64 and in != end; shift += 7) {
+        unsigned char byte = *in++;
+        val |= std::uint64_t(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+/*!
+ * \brief The Chunk struct is the position of an encoded payload in a buffer.
+ */
+struct Chunk {
+    unsigned char const* data;
+    std::size_t size;
+};
+
+template <typename Codec, typename V>
+std::size_t payload_size(V const& val) {
+    if constexpr (Codec::fixed_size > 0) {
+        return Codec::fixed_size;
+    } else {
+        std::size_t size = Codec::size(val);
+        return varint_size(size) + size;
+    }
+}
+
+template <typename Codec, typename V>
+unsigned char* write_payload(V const& val, unsigned char* out) {
+    if constexpr (Codec::fixed_size > 0) {
+        Codec::encode(val, out);
+        return out + Codec::fixed_size;
+    } else {
+        std::size_t size = Codec::size(val);
+        out = write_varint(size, out);
+        Codec::encode(val, out);
+        return out + size;
+    }
+}
+
+template <typename Codec, typename = void>
+struct codec_checks_size : std::false_type {};
+
+template <typename Codec>
+struct codec_checks_size<Codec, std::void_t<decltype(Codec::accepts_size(std::size_t()))>> : std::true_type {};
+
+/*!
+ * \brief read_payload locate the payload starting at in, and return the position after it, or nullptr if it does not fit before end
+ * or has a length the codec does not accept.
+ */
+template <typename Codec>
+unsigned char const* read_payload(unsigned char const* in, unsigned char const* end, Chunk & chunk) noexcept {
+    std::uint64_t size = Codec::fixed_size;
+    if constexpr (Codec::fixed_size == 0) {
+        in = read_varint(in, end, size);
+        if (in == nullptr) {
+            return nullptr;
+        }
+    }
+    if (size > static_cast<std::uint64_t>(end - in)) {
+        return nullptr;
+    }
+    if constexpr (codec_checks_size<Codec>::value) {
+        if (!Codec::accepts_size(static_cast<std::size_t>(size))) {
+            return nullptr;
+        }
+    }
+    chunk = Chunk{in, static_cast<std::size_t>(size)};
+    return in + size;
+}
+
+} // namespace status_optional_detail
+
+/*!
+ * \brief status_optional_encoded_size give the number of bytes status_optional_encode writes for result
+ */
+template <typename T, typename MsgT>
+std::size_t status_optional_encoded_size(StatusOptional<T, MsgT> const& result) {
+    using Access = status_optional_detail::Access;
+
+    std::size_t ret = 1;
+    if constexpr (!std::is_void_v<T>) {
+        if (result.has_value()) {
+            ret += status_optional_detail::payload_size<status_optional_detail::codec_for<T>>(Access::stored_value(result));
+        }
+    }
+    if (result.has_message()) {
+        ret += status_optional_detail::payload_size<status_optional_detail::message_codec_for<MsgT>>(result.message());
+    }
+    return ret;
+}
+
+/*!
+ * \brief status_optional_encode write result at out, which must have room for status_optional_encoded_size(result) bytes, and return the position after it
+ */
+template <typename T, typename MsgT>
+unsigned char* status_optional_encode(StatusOptional<T, MsgT> const& result, unsigned char* out) {
+    using Access = status_optional_detail::Access;
+    static_assert(std::is_void_v<T> or status_optional_detail::codec_for<T>::available, "no status_optional_codec for the value type");
+    static_assert(status_optional_detail::message_codec_for<MsgT>::available, "no status_optional_codec for the message type");
+
+    *out++ = static_cast<unsigned char>(result.state());
+    if constexpr (!std::is_void_v<T>) {
+        if (result.has_value()) {
+            out = status_optional_detail::write_payload<status_optional_detail::codec_for<T>>(Access::stored_value(result), out);
+        }
+    }
+    if (result.has_message()) {
+        out = status_optional_detail::write_payload<status_optional_detail::message_codec_for<MsgT>>(result.message(), out);
+    }
+    return out;
+}
+
+/*!
+ * \brief status_optional_encode append result to out
+ */
+template <typename T, typename MsgT>
+void status_optional_encode(StatusOptional<T, MsgT> const& result, std::vector<unsigned char> & out) {
+    std::size_t start = out.size();
+    out.resize(start + status_optional_encoded_size(result));
+    status_optional_encode(result, out.data() + start);
+}
+
+/*!
+ * \brief The StatusOptionalView class reads a StatusOptional<T, MsgT> encoded in a buffer, without decoding its payloads.
+ *
+ * The constructor only reads the state and the lengths. value() and message() decode the payload on each call,
+ * value_bytes() and message_bytes() give the encoded bytes. The buffer must outlive the view.
+ *
+ * If the buffer does not start with an encoded StatusOptional (it is truncated, or the state is unknown),
+ * well_formed() is false and the view is invalid.
+ */
+template <typename T, typename MsgT = std::string>
+class StatusOptionalView {
+
+    static_assert(!std::is_reference_v<T>, "decode a StatusOptional<T, MsgT> rather than a StatusOptional<T&, MsgT>");
+
+    using ValueCodec = std::conditional_t<std::is_void_v<T>, status_optional_trivial_codec<unsigned char>, status_optional_codec<T>>;
+    using MessageCodec = status_optional_detail::message_codec_for<MsgT>;
+    using MessageValue = typename status_message_traits<MsgT>::value_type;
+
+public:
+
+    typedef T ValueType;
+    typedef MsgT MessageType;
+    typedef StatusOptional<T, MsgT> ElementType;
+
+    StatusOptionalView(unsigned char const* data, std::size_t size) noexcept :
+        _value{nullptr, 0},
+        _message{nullptr, 0},
+        _encodedSize(0),
+        _state(StatusOptionalState::Invalid),
+        _wellFormed(false)
+    {
+        parse(data, data + size);
+    }
+
+    bool well_formed() const {
+        return _wellFormed;
+    }
+
+    /*!
+     * \brief encoded_size give the number of bytes of the encoded StatusOptional, where the next one starts in a stream.
+     */
+    std::size_t encoded_size() const {
+        return _encodedSize;
+    }
+
+    constexpr StatusOptionalState state() const {
+        return _state;
+    }
+
+    explicit operator bool() const {
+        return has_value();
+    }
+
+    bool has_value() const {
+        return static_cast<unsigned char>(_state) & status_optional_detail::ValueFlag;
+    }
+
+    bool has_message() const {
+        return static_cast<unsigned char>(_state) & status_optional_detail::MessageFlag;
+    }
+
+    bool is_valid() const {
+        return _state != StatusOptionalState::Invalid;
+    }
+
+    bool is_no_error_or_warning() const {
+        return _state == StatusOptionalState::Ok;
+    }
+
+    bool is_warning() const {
+        return _state == StatusOptionalState::Warning;
+    }
+
+    bool is_error() const {
+        return _state == StatusOptionalState::Error;
+    }
+
+    /*!
+     * \brief value decode the value, the view must have a value.
+     */
+    template <typename U = T, std::enable_if_t<!std::is_void_v<U>, bool> = true>
+    U value() const {
+        if (!has_value()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return ValueCodec::decode(_value.data, _value.size);
+    }
+
+    /*!
+     * \brief message decode the message, the view must have a message.
+     */
+    MessageValue message() const {
+        if (!has_message()) STATUS_OPTIONAL_UNLIKELY {
+            status_optional_detail::throw_bad_optional_access();
+        }
+        return MessageCodec::decode(_message.data, _message.size);
+    }
+
+    unsigned char const* value_bytes() const {
+        return _value.data;
+    }
+
+    std::size_t value_bytes_size() const {
+        return _value.size;
+    }
+
+    unsigned char const* message_bytes() const {
+        return _message.data;
+    }
+
+    std::size_t message_bytes_size() const {
+        return _message.size;
+    }
+
+    /*!
+     * \brief Decode the payloads into a StatusOptional
+     */
+    operator ElementType() const {
+        switch (_state) {
+        case StatusOptionalState::Ok:
+            if constexpr (std::is_void_v<T>) {
+                return ElementType();
+            } else {
+                return ElementType(std::in_place, value());
+            }
+        case StatusOptionalState::Warning:
+            if constexpr (std::is_void_v<T>) {
+                return ElementType::warning_in_place(message());
+            } else {
+                return ElementType::warning_in_place(std::piecewise_construct, std::forward_as_tuple(value()), std::forward_as_tuple(message()));
+            }
+        case StatusOptionalState::Error:
+            return ElementType::error_in_place(message());
+        case StatusOptionalState::Invalid:
+        default:
+            return status_optional_detail::Access::invalid<ElementType>();
+        }
+    }
+
+protected:
+
+    void parse(unsigned char const* in, unsigned char const* end) noexcept {
+        unsigned char const* begin = in;
+        if (in == end or *in > static_cast<unsigned char>(StatusOptionalState::Warning)) {
+            return;
+        }
+        unsigned char flags = *in++;
+        if constexpr (!std::is_void_v<T>) {
+            if (flags & status_optional_detail::ValueFlag) {
+                in = status_optional_detail::read_payload<ValueCodec>(in, end, _value);
+                if (in == nullptr) {
+                    return;
+                }
+            }
+        }
+        if (flags & status_optional_detail::MessageFlag) {
+            in = status_optional_detail::read_payload<MessageCodec>(in, end, _message);
+            if (in == nullptr) {
+                return;
+            }
+        }
+        _state = static_cast<StatusOptionalState>(flags);
+        _encodedSize = static_cast<std::size_t>(in - begin);
+        _wellFormed = true;
+    }
+
+    status_optional_detail::Chunk _value;
+    status_optional_detail::Chunk _message;
+    std::size_t _encodedSize;
+    StatusOptionalState _state;
+    bool _wellFormed;
+};
+
+/*!
+ * \brief status_optional_decode build the StatusOptional encoded at the start of data, or an invalid StatusOptional if it is not well formed
+ */
+template <typename T, typename MsgT = std::string>
+StatusOptional<T, MsgT> status_optional_decode(unsigned char const* data, std::size_t size) {
+    return StatusOptionalView<T, MsgT>(data, size);
+}
+
+/*!
+ * \brief status_optional_encode append batch to out, as the number of elements, the two state bitmasks, the values and the messages.
+ *
+ * With a fixed size codec for T, the values of all the elements (placeholders included) follow each other,
+ * and are copied at once for the trivially copied types. The messages follow, in index order.
+ */
+template <typename T, typename MsgT>
+void status_optional_encode(StatusOptionalBatch<T, MsgT> const& batch, std::vector<unsigned char> & out) {
+    using ValueCodec = status_optional_codec<T>;
+    using MessageCodec = status_optional_detail::message_codec_for<MsgT>;
+    static_assert(ValueCodec::available, "no status_optional_codec for the value type");
+    static_assert(MessageCodec::available, "no status_optional_codec for the message type");
+
+    std::size_t words = batch.word_count();
+    std::size_t size = status_optional_detail::varint_size(batch.size()) + 2 * words * sizeof(std::uint64_t);
+    if constexpr (ValueCodec::fixed_size > 0) {
+        size += batch.size() * ValueCodec::fixed_size;
+    } else {
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            size += status_optional_detail::payload_size<ValueCodec>(batch.value_data()[i]);
+        }
+    }
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        if (batch[i].has_message()) {
+            size += status_optional_detail::payload_size<MessageCodec>(batch[i].unchecked_message());
+        }
+    }
+
+    std::size_t start = out.size();
+    out.resize(start + size);
+    unsigned char* it = status_optional_detail::write_varint(batch.size(), out.data() + start);
+    if (words > 0) {
+        std::memcpy(it, batch.value_words(), words * sizeof(std::uint64_t));
+        it += words * sizeof(std::uint64_t);
+        std::memcpy(it, batch.message_words(), words * sizeof(std::uint64_t));
+        it += words * sizeof(std::uint64_t);
+    }
+    if constexpr (std::is_base_of_v<status_optional_trivial_codec<T>, ValueCodec>) {
+        if (!batch.empty()) {
+            std::memcpy(it, batch.value_data(), batch.size() * sizeof(T));
+            it += batch.size() * sizeof(T);
+        }
+    } else {
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            it = status_optional_detail::write_payload<ValueCodec>(batch.value_data()[i], it);
+        }
+    }
+    for (std::size_t w = 0; w < words; w++) {
+        std::uint64_t bits = batch.message_words()[w];
+        while (bits != 0) {
+            std::size_t index = w * StatusOptionalBatch<T, MsgT>::WordBits + status_optional_detail::countr_zero64(bits);
+            it = status_optional_detail::write_payload<MessageCodec>(batch[index].unchecked_message(), it);
+            bits &= bits - 1;
+        }
+    }
+}
+
+/*!
+ * \brief status_optional_decode_batch append the elements of the batch encoded at the start of data to out, and return false if it is not well formed.
+ *
+ * A batch which is not well formed leaves out as it was.
+ */
+template <typename T, typename MsgT>
+bool status_optional_decode_batch(unsigned char const* data, std::size_t size, StatusOptionalBatch<T, MsgT> & out) {
+    using ValueCodec = status_optional_codec<T>;
+    using MessageCodec = status_optional_detail::message_codec_for<MsgT>;
+    constexpr std::size_t WordBits = StatusOptionalBatch<T, MsgT>::WordBits;
+
+    unsigned char const* end = data + size;
+    std::uint64_t count = 0;
+    unsigned char const* in = status_optional_detail::read_varint(data, end, count);
+    if (in == nullptr) {
+        return false;
+    }
+    std::uint64_t words = (count + WordBits - 1) / WordBits;
+    if (words > static_cast<std::uint64_t>(end - in) / (2 * sizeof(std::uint64_t))) {
+        return false;
+    }
+    // each value takes at least a byte, which bounds the count before allocating for it.
+    std::uint64_t remaining = static_cast<std::uint64_t>(end - in) - 2 * words * sizeof(std::uint64_t);
+    if (count > remaining / (ValueCodec::fixed_size > 0 ? ValueCodec::fixed_size : 1)) {
+        return false;
+    }
+    std::vector<std::uint64_t> valueWords(static_cast<std::size_t>(words));
+    std::vector<std::uint64_t> messageWords(static_cast<std::size_t>(words));
+    if (words > 0) {
+        std::memcpy(valueWords.data(), in, words * sizeof(std::uint64_t));
+        in += words * sizeof(std::uint64_t);
+        std::memcpy(messageWords.data(), in, words * sizeof(std::uint64_t));
+        in += words * sizeof(std::uint64_t);
+    }
+
+    // locate all the payloads first, so nothing is appended to out if the batch is truncated.
+    // With a fixed size codec the values follow each other, and only the messages need to be located.
+    std::vector<status_optional_detail::Chunk> values;
+    unsigned char const* fixedValues = in;
+    if constexpr (ValueCodec::fixed_size > 0) {
+        in += count * ValueCodec::fixed_size;
+    } else {
+        values.resize(static_cast<std::size_t>(count));
+        for (status_optional_detail::Chunk & chunk : values) {
+            in = status_optional_detail::read_payload<ValueCodec>(in, end, chunk);
+            if (in == nullptr) {
+                return false;
+            }
+        }
+    }
+    std::vector<status_optional_detail::Chunk> messages;
+    for (std::uint64_t word : messageWords) {
+        for (int b = status_optional_detail::popcount64(word); b > 0; b--) {
+            messages.emplace_back();
+            in = status_optional_detail::read_payload<MessageCodec>(in, end, messages.back());
+            if (in == nullptr) {
+                return false;
+            }
+        }
+    }
+
+    auto decodeValue = [&values, fixedValues] (std::size_t i) {
+        if constexpr (ValueCodec::fixed_size > 0) {
+            (void) values;
+            return ValueCodec::decode(fixedValues + i * ValueCodec::fixed_size, ValueCodec::fixed_size);
+        } else {
+            (void) fixedValues;
+            return ValueCodec::decode(values[i].data, values[i].size);
+        }
+    };
+
+    out.reserve(out.size() + static_cast<std::size_t>(count));
+    std::size_t nextMessage = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        bool hasValue = (valueWords[i / WordBits] >> (i % WordBits)) & 1;
+        bool hasMessage = (messageWords[i / WordBits] >> (i % WordBits)) & 1;
+        if (hasMessage) {
+            status_optional_detail::Chunk msg = messages[nextMessage++];
+            if (hasValue) {
+                out.push_warning(decodeValue(i), MessageCodec::decode(msg.data, msg.size));
+            } else {
+                out.push_error(MessageCodec::decode(msg.data, msg.size));
+            }
+        } else if (hasValue) {
+            out.push_value(decodeValue(i));
+        } else {
+            out.push_invalid();
+        }
+    }
+    return true;
+}
+
+#endif // STATUS_OPTIONAL_SERIALIZATION_H
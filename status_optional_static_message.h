@@ -0,0 +1,154 @@
+#ifndef STATUS_OPTIONAL_STATIC_MESSAGE_H
+#define STATUS_OPTIONAL_STATIC_MESSAGE_H
+
+#include <cstddef>
+#include <string_view>
+
+#include "./status_optional.h"
+
+/*!
+ * \brief The StaticMessage class is a message type referring to a string with static storage duration.
+ *
+ * It only holds a pointer and a size, so StatusOptional<T, StaticMessage>::error("...") does not allocate,
+ * and StaticMessage is trivially copyable and usable in constant expressions.
+ * It must only be built from string literals (or other strings outliving every copy of the message),
+ * as the string is never copied.
+ */
+class StaticMessage {
+public:
+
+    constexpr StaticMessage() noexcept :
+        _str(""),
+        _size(0)
+    {
+
+    }
+
+    template <std::size_t N>
+    constexpr StaticMessage(char const (&literal)[N]) noexcept :
+        _str(literal),
+        _size(N-1)
+    {
+
+    }
+
+    /*!
+     * \brief from_static_string build a StaticMessage from a null terminated string with static storage duration
+     */
+    static constexpr StaticMessage from_static_string(char const* str, std::size_t size) noexcept {
+        StaticMessage ret;
+        ret._str = str;
+        ret._size = size;
+        return ret;
+    }
+
+    constexpr char const* c_str() const noexcept {
+        return _str;
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return _size;
+    }
+
+    constexpr std::string_view view() const noexcept {
+        return std::string_view(_str, _size);
+    }
+
+    friend constexpr bool operator==(StaticMessage const& a, StaticMessage const& b) noexcept {
+        return a.view() == b.view();
+    }
+
+    friend constexpr bool operator!=(StaticMessage const& a, StaticMessage const& b) noexcept {
+        return a.view() != b.view();
+    }
+
+protected:
+    char const* _str;
+    std::size_t _size;
+};
+
+/*!
+ * \brief The StatusCategory class gives a name and a description function to a family of StatusCode.
+ *
+ * Categories are meant to be defined as constexpr variables, and compared by address.
+ */
+class StatusCategory {
+public:
+
+    typedef char const* (*Describe)(int code);
+
+    constexpr StatusCategory(char const* name, Describe describe = nullptr) noexcept :
+        _name(name),
+        _describe(describe)
+    {
+
+    }
+
+    constexpr char const* name() const noexcept {
+        return _name;
+    }
+
+    char const* message(int code) const {
+        if (_describe == nullptr) {
+            return "";
+        }
+        return _describe(code);
+    }
+
+protected:
+    char const* _name;
+    Describe _describe;
+};
+
+/*!
+ * \brief The StatusCode class is a message type made of an integer code and a pointer to its category.
+ *
+ * Like StaticMessage it is trivially copyable and never allocates,
+ * the description of the code is only looked up when message() is called.
+ */
+class StatusCode {
+public:
+
+    constexpr StatusCode() noexcept :
+        _code(0),
+        _category(nullptr)
+    {
+
+    }
+
+    constexpr StatusCode(int code, StatusCategory const& category) noexcept :
+        _code(code),
+        _category(&category)
+    {
+
+    }
+
+    constexpr int code() const noexcept {
+        return _code;
+    }
+
+    constexpr StatusCategory const* category() const noexcept {
+        return _category;
+    }
+
+    char const* message() const {
+        if (_category == nullptr) {
+            return "";
+        }
+        return _category->message(_code);
+    }
+
+    friend constexpr bool operator==(StatusCode const& a, StatusCode const& b) noexcept {
+        return a._code == b._code and a._category == b._category;
+    }
+
+    friend constexpr bool operator!=(StatusCode const& a, StatusCode const& b) noexcept {
+        return !(a == b);
+    }
+
+protected:
+    int _code;
+    StatusCategory const* _category;
+};
+
+#endif // STATUS_OPTIONAL_STATIC_MESSAGE_H
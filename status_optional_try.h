@@ -0,0 +1,86 @@
+#ifndef STATUS_OPTIONAL_TRY_H
+#define STATUS_OPTIONAL_TRY_H
+
+#include <utility>
+
+#include "./status_optional.h"
+
+namespace status_optional_detail {
+
+/*!
+ * \brief The FailureProxy class is returned by STATUS_OPTIONAL_TRY, and converts to the StatusOptional returned by the enclosing function.
+ *
+ * The conversion builds the result directly from the failed StatusOptional, so its message is moved (or copied from an lvalue) only once.
+ */
+template <typename Failed>
+class FailureProxy {
+public:
+
+    using MsgT = typename remove_cvref_t<Failed>::MessageType;
+
+    explicit FailureProxy(Failed && failed) :
+        _failed(&failed)
+    {
+
+    }
+
+    template <typename U>
+    operator StatusOptional<U, MsgT>() && {
+        return Access::failure_from<StatusOptional<U, MsgT>>(std::forward<Failed>(*_failed));
+    }
+
+protected:
+    std::remove_reference_t<Failed>* _failed;
+};
+
+template <typename Failed>
+FailureProxy<Failed&&> propagate_failure(Failed && failed) {
+    return FailureProxy<Failed&&>(std::forward<Failed>(failed));
+}
+
+} // namespace status_optional_detail
+
+#define STATUS_OPTIONAL_CONCAT_IMPL(a, b) a##b
+#define STATUS_OPTIONAL_CONCAT(a, b) STATUS_OPTIONAL_CONCAT_IMPL(a, b)
+
+/*!
+ * \brief STATUS_OPTIONAL_TRY evaluate expr, a StatusOptional, and return its error (or its invalid state) from the enclosing function.
+ *
+ * The enclosing function must return a StatusOptional with the same message type, and any value type.
+ * The message is moved when expr is an rvalue, and copied when it is an lvalue. A warning does not return, and its message is dropped.
+ *
+ * \code
+ * StatusOptional<void, std::string> validate(Config const& config) {
+ *     STATUS_OPTIONAL_TRY(check_paths(config));
+ *     return check_limits(config);
+ * }
+ * \endcode
+ */
+#define STATUS_OPTIONAL_TRY(expr) \
+    do { \
+        auto&& _statusOptionalTried = (expr); \
+        if (!::status_optional_detail::Access::succeeded(_statusOptionalTried)) STATUS_OPTIONAL_UNLIKELY { \
+            return ::status_optional_detail::propagate_failure(std::forward<decltype(_statusOptionalTried)>(_statusOptionalTried)); \
+        } \
+    } while (false)
+
+#define STATUS_OPTIONAL_TRY_ASSIGN_IMPL(tried, lhs, expr) \
+    auto&& tried = (expr); \
+    if (!::status_optional_detail::Access::succeeded(tried)) STATUS_OPTIONAL_UNLIKELY { \
+        return ::status_optional_detail::propagate_failure(std::forward<decltype(tried)>(tried)); \
+    } \
+    lhs = ::status_optional_detail::Access::stored_value(std::forward<decltype(tried)>(tried))
+
+/*!
+ * \brief STATUS_OPTIONAL_TRY_ASSIGN evaluate expr, return its error from the enclosing function as STATUS_OPTIONAL_TRY does, or assign its value to lhs.
+ *
+ * lhs can be a declaration, the value is moved when expr is an rvalue:
+ *
+ * \code
+ * STATUS_OPTIONAL_TRY_ASSIGN(int port, parse_port(text));
+ * \endcode
+ */
+#define STATUS_OPTIONAL_TRY_ASSIGN(lhs, expr) \
+    STATUS_OPTIONAL_TRY_ASSIGN_IMPL(STATUS_OPTIONAL_CONCAT(_statusOptionalTried, __LINE__), lhs, expr)
+
+#endif // STATUS_OPTIONAL_TRY_H
@@ -0,0 +1,317 @@
+#ifndef STATUS_OPTIONAL_WARNING_LIST_H
+#define STATUS_OPTIONAL_WARNING_LIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "./status_optional.h"
+
+/*!
+ * \brief The WarningList class is a message type holding several messages, the first N of them stored inline.
+ *
+ * StatusOptional<T, WarningList<MsgT>> accumulates the warnings of a pipeline instead of keeping only the last one:
+ * and_then merges the warnings of its input and of the result of its callback, collect merges the warnings of a range,
+ * and merge_warnings appends the warnings of a result to another one. The messages are moved, never copied,
+ * and no allocation happens until more than N messages are held.
+ *
+ * A WarningList is built implicitly from anything a MsgT can be built from, so StatusOptional<T, WarningList<>>::warning(val, "text") works,
+ * and message() returns the list, which iterates over the messages in the order they were added.
+ */
+template <typename MsgT = std::string, std::size_t N = 2>
+class WarningList {
+public:
+
+    static_assert(N > 0, "WarningList needs room for at least one message inline");
+
+    typedef MsgT value_type;
+    typedef MsgT* iterator;
+    typedef MsgT const* const_iterator;
+
+    WarningList() noexcept :
+        _data(inline_data()),
+        _size(0),
+        _capacity(N)
+    {
+
+    }
+
+    template <typename U,
+              std::enable_if_t<!std::is_same_v<std::decay_t<U>, WarningList> and
+                               std::is_constructible_v<MsgT, U&&>, bool> = true>
+    WarningList(U && msg) :
+        WarningList()
+    {
+        emplace_back(std::forward<U>(msg));
+    }
+
+    WarningList(WarningList const& other) :
+        WarningList()
+    {
+        append(other);
+    }
+
+    WarningList(WarningList && other) noexcept(std::is_nothrow_move_constructible_v<MsgT>) :
+        WarningList()
+    {
+        steal(std::move(other));
+    }
+
+    WarningList& operator=(WarningList const& other) {
+        if (this != &other) {
+            clear();
+            append(other);
+        }
+        return *this;
+    }
+
+    WarningList& operator=(WarningList && other) noexcept(std::is_nothrow_move_constructible_v<MsgT>) {
+        if (this != &other) {
+            clear();
+            release();
+            steal(std::move(other));
+        }
+        return *this;
+    }
+
+    ~WarningList() {
+        clear();
+        release();
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    /*!
+     * \brief is_inline tells if the messages are still stored in the inline buffer.
+     */
+    bool is_inline() const {
+        return _data == inline_data();
+    }
+
+    iterator begin() {
+        return _data;
+    }
+
+    iterator end() {
+        return _data + _size;
+    }
+
+    const_iterator begin() const {
+        return _data;
+    }
+
+    const_iterator end() const {
+        return _data + _size;
+    }
+
+    MsgT& operator[](std::size_t i) {
+        return _data[i];
+    }
+
+    MsgT const& operator[](std::size_t i) const {
+        return _data[i];
+    }
+
+    MsgT& front() {
+        return _data[0];
+    }
+
+    MsgT const& front() const {
+        return _data[0];
+    }
+
+    MsgT& back() {
+        return _data[_size-1];
+    }
+
+    MsgT const& back() const {
+        return _data[_size-1];
+    }
+
+    template <typename... Args>
+    MsgT& emplace_back(Args&&... args) {
+        if (_size == _capacity) {
+            // args may refer to a message of the list, which grow moves: build the new message first
+            MsgT built(std::forward<Args>(args)...);
+            grow(2*_capacity);
+            MsgT* msg = ::new (static_cast<void*>(_data + _size)) MsgT(std::move(built));
+            _size++;
+            return *msg;
+        }
+        MsgT* msg = ::new (static_cast<void*>(_data + _size)) MsgT(std::forward<Args>(args)...);
+        _size++;
+        return *msg;
+    }
+
+    void push_back(MsgT const& msg) {
+        emplace_back(msg);
+    }
+
+    void push_back(MsgT && msg) {
+        emplace_back(std::move(msg));
+    }
+
+    /*!
+     * \brief append move the messages of other at the end of the list, taking over its heap buffer when the list is empty.
+     */
+    void append(WarningList && other) {
+        if (&other == this) {
+            append(static_cast<WarningList const&>(other));
+            return;
+        }
+        if (empty() and !other.is_inline()) {
+            release();
+            steal(std::move(other));
+            return;
+        }
+        reserve(_size + other._size);
+        for (MsgT & msg : other) {
+            ::new (static_cast<void*>(_data + _size)) MsgT(std::move(msg));
+            _size++;
+        }
+        other.clear();
+    }
+
+    /*!
+     * \brief append copy the messages of other at the end of the list, other can be the list itself.
+     */
+    void append(WarningList const& other) {
+        // when other is this list, reserve may move its messages and the loop adds to it, so index up to the initial size
+        std::size_t const count = other._size;
+        reserve(_size + count);
+        for (std::size_t i = 0; i < count; i++) {
+            ::new (static_cast<void*>(_data + _size)) MsgT(other._data[i]);
+            _size++;
+        }
+    }
+
+    void reserve(std::size_t capacity) {
+        if (capacity > _capacity) {
+            grow(std::max(capacity, 2*_capacity));
+        }
+    }
+
+    void clear() {
+        std::destroy(begin(), end());
+        _size = 0;
+    }
+
+    friend bool operator==(WarningList const& a, WarningList const& b) {
+        if (a._size != b._size) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a._size; i++) {
+            if (!(a._data[i] == b._data[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    friend bool operator!=(WarningList const& a, WarningList const& b) {
+        return !(a == b);
+    }
+
+protected:
+
+    MsgT* inline_data() {
+        return reinterpret_cast<MsgT*>(_inline);
+    }
+
+    MsgT const* inline_data() const {
+        return reinterpret_cast<MsgT const*>(_inline);
+    }
+
+    void grow(std::size_t capacity) {
+        MsgT* data = std::allocator<MsgT>().allocate(capacity);
+        std::uninitialized_move(begin(), end(), data);
+        std::size_t size = _size;
+        clear();
+        release();
+        _data = data;
+        _size = size;
+        _capacity = capacity;
+    }
+
+    /*!
+     * \brief release free the heap buffer, if any, the list must be empty.
+     */
+    void release() {
+        if (!is_inline()) {
+            std::allocator<MsgT>().deallocate(_data, _capacity);
+            _data = inline_data();
+            _capacity = N;
+        }
+    }
+
+    /*!
+     * \brief steal take over the messages of other, the list must be empty and inline.
+     */
+    void steal(WarningList && other) {
+        if (other.is_inline()) {
+            std::uninitialized_move(other.begin(), other.end(), _data);
+            _size = other._size;
+            other.clear();
+        } else {
+            _data = other._data;
+            _size = other._size;
+            _capacity = other._capacity;
+            other._data = other.inline_data();
+            other._size = 0;
+            other._capacity = N;
+        }
+    }
+
+    MsgT* _data;
+    std::size_t _size;
+    std::size_t _capacity;
+    alignas(MsgT) unsigned char _inline[N*sizeof(MsgT)];
+};
+
+template <typename MsgT, std::size_t N>
+struct status_message_merge<WarningList<MsgT, N>> {
+
+    static constexpr bool accumulate = true;
+
+    static void merge(WarningList<MsgT, N> & into, WarningList<MsgT, N> && from) {
+        into.append(std::move(from));
+    }
+};
+
+/*!
+ * \brief merge_warnings append the warnings of from to the messages of into, and return false if from is not a warning.
+ *
+ * into becomes a warning if it held a value without message, and an error or an invalid StatusOptional is left as it is.
+ */
+template <typename T, typename U, typename MsgT, std::size_t N>
+bool merge_warnings(StatusOptional<T, WarningList<MsgT, N>> & into, StatusOptional<U, WarningList<MsgT, N>> && from) {
+    if (!from.is_warning()) {
+        return false;
+    }
+    if (!status_optional_detail::Access::succeeded(into)) {
+        return true;
+    }
+    WarningList<MsgT, N> && messages = status_optional_detail::Access::stored_message(std::move(from));
+    if (into.has_message()) {
+        status_optional_detail::Access::stored_message(into).append(std::move(messages));
+    } else {
+        status_optional_detail::Access::attach_warning(into, std::move(messages));
+    }
+    return true;
+}
+
+#endif // STATUS_OPTIONAL_WARNING_LIST_H
@@ -0,0 +1,274 @@
+#ifndef STATUS_OPTIONAL_WARNING_SINK_H
+#define STATUS_OPTIONAL_WARNING_SINK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./status_optional.h"
+
+/*!
+ * \brief The WarningSink class is a bounded lock free queue collecting the warning messages of many producer threads for a single consumer.
+ *
+ * Producers hand a warning over with take_message(result), which moves the message once into the queue and never blocks:
+ * when the queue is full the message is left in result, and the drop is counted. The consumer calls drain() to process
+ * the messages in the order they were queued. take_message and push can be called concurrently from any number of threads,
+ * drain from one thread at a time.
+ *
+ * A Producer, obtained with producer(), batches the messages of a thread and queues a whole batch at once,
+ * so the threads only contend on the queue once per batch.
+ *
+ * The queue is the bounded queue of Dmitry Vyukov: each cell holds a sequence number telling
+ * the producers and the consumer whether the cell is free or filled for the current round.
+ */
+template <typename MsgT = std::string>
+class WarningSink {
+public:
+
+    class Producer;
+
+    /*!
+     * \brief Construct a WarningSink able to hold capacity messages, rounded up to a power of two.
+     */
+    explicit WarningSink(std::size_t capacity) :
+        _mask(round_up_capacity(capacity) - 1),
+        _cells(new Cell[_mask + 1]),
+        _enqueuePos(0),
+        _dequeuePos(0),
+        _dropped(0)
+    {
+        for (std::size_t i = 0; i <= _mask; i++) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    WarningSink(WarningSink const&) = delete;
+    WarningSink& operator=(WarningSink const&) = delete;
+
+    ~WarningSink() {
+        drain([] (MsgT &&) {});
+    }
+
+    std::size_t capacity() const {
+        return _mask + 1;
+    }
+
+    /*!
+     * \brief dropped count the messages which were not queued because the sink was full.
+     */
+    std::uint64_t dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief push queue msg, or return false, leaving msg unchanged, if the sink is full.
+     */
+    bool push(MsgT && msg) {
+        std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        if (!reserve(pos, 1)) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        publish(pos, std::move(msg));
+        return true;
+    }
+
+    /*!
+     * \brief take_message move the message of result into the sink if result is a warning.
+     * \return true if the message has been queued, false if result is not a warning or the sink is full.
+     *
+     * result keeps its state, and a moved from message once it has been taken.
+     */
+    template <typename T>
+    bool take_message(StatusOptional<T, MsgT> & result) {
+        if (!result.is_warning()) {
+            return false;
+        }
+        return push(status_optional_detail::Access::stored_message(std::move(result)));
+    }
+
+    /*!
+     * \brief drain call f on each queued message, moved out of the sink, and return the number of messages processed.
+     *
+     * The messages queued while drain runs may or may not be processed.
+     */
+    template <typename F>
+    std::size_t drain(F && f) {
+        std::size_t count = 0;
+        std::size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell & cell = _cells[pos & _mask];
+            if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            MsgT* msg = cell.message();
+            status_optional_detail::invoke(f, std::move(*msg));
+            msg->~MsgT();
+            cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+            pos++;
+            count++;
+        }
+        _dequeuePos.store(pos, std::memory_order_relaxed);
+        return count;
+    }
+
+    /*!
+     * \brief drain move the queued messages to a vector.
+     */
+    std::vector<MsgT> drain() {
+        std::vector<MsgT> ret;
+        drain([&ret] (MsgT && msg) { ret.push_back(std::move(msg)); });
+        return ret;
+    }
+
+    /*!
+     * \brief producer return a Producer queuing its messages batchSize at a time (at most the capacity of the sink).
+     */
+    Producer producer(std::size_t batchSize = 32) {
+        return Producer(*this, batchSize < capacity() ? batchSize : capacity());
+    }
+
+protected:
+
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        alignas(MsgT) unsigned char storage[sizeof(MsgT)];
+
+        MsgT* message() {
+            return std::launder(reinterpret_cast<MsgT*>(storage));
+        }
+    };
+
+    static std::size_t round_up_capacity(std::size_t capacity) {
+        std::size_t ret = 1;
+        while (ret < capacity) {
+            ret <<= 1;
+        }
+        return ret;
+    }
+
+    /*!
+     * \brief reserve claim the count cells starting at pos (updated to the current enqueue position), or return false if they are not all free.
+     *
+     * The consumer frees the cells in order, so the count cells are free if the last of them is.
+     */
+    bool reserve(std::size_t & pos, std::size_t count) {
+        for (;;) {
+            std::size_t last = pos + count - 1;
+            std::size_t sequence = _cells[last & _mask].sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(last);
+            if (diff == 0) {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(std::size_t pos, MsgT && msg) {
+        Cell & cell = _cells[pos & _mask];
+        new (cell.storage) MsgT(std::move(msg));
+        cell.sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    /*!
+     * \brief push_batch queue the messages of batch, in one reservation when they all fit, and one by one otherwise.
+     */
+    void push_batch(std::vector<MsgT> & batch) {
+        std::size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        if (reserve(pos, batch.size())) {
+            for (MsgT & msg : batch) {
+                publish(pos++, std::move(msg));
+            }
+        } else {
+            for (MsgT & msg : batch) {
+                push(std::move(msg));
+            }
+        }
+        batch.clear();
+    }
+
+    std::size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    // the producers and the consumer update their own position, kept on separate cache lines.
+    alignas(64) std::atomic<std::size_t> _enqueuePos;
+    alignas(64) std::atomic<std::size_t> _dequeuePos;
+    alignas(64) std::atomic<std::uint64_t> _dropped;
+};
+
+/*!
+ * \brief The Producer class batches the messages of one thread before queuing them in a WarningSink.
+ *
+ * A Producer must only be used by one thread. The batch is queued once full, on flush() and on destruction,
+ * and the messages which do not fit in the sink at that time are dropped.
+ */
+template <typename MsgT>
+class WarningSink<MsgT>::Producer {
+public:
+
+    Producer(Producer && other) :
+        _sink(other._sink),
+        _batchSize(other._batchSize),
+        _batch(std::move(other._batch))
+    {
+        other._sink = nullptr;
+    }
+
+    Producer& operator=(Producer && other) = delete;
+
+    ~Producer() {
+        flush();
+    }
+
+    void push(MsgT && msg) {
+        _batch.push_back(std::move(msg));
+        if (_batch.size() >= _batchSize) {
+            flush();
+        }
+    }
+
+    /*!
+     * \brief take_message move the message of result into the batch if result is a warning, and return if it did.
+     */
+    template <typename T>
+    bool take_message(StatusOptional<T, MsgT> & result) {
+        if (!result.is_warning()) {
+            return false;
+        }
+        push(status_optional_detail::Access::stored_message(std::move(result)));
+        return true;
+    }
+
+    void flush() {
+        if (_sink != nullptr and !_batch.empty()) {
+            _sink->push_batch(_batch);
+        }
+    }
+
+protected:
+
+    friend class WarningSink<MsgT>;
+
+    Producer(WarningSink<MsgT> & sink, std::size_t batchSize) :
+        _sink(&sink),
+        _batchSize(batchSize > 0 ? batchSize : 1)
+    {
+        _batch.reserve(_batchSize);
+    }
+
+    WarningSink<MsgT>* _sink;
+    std::size_t _batchSize;
+    std::vector<MsgT> _batch;
+};
+
+#endif // STATUS_OPTIONAL_WARNING_SINK_H
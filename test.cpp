@@ -1,6 +1,27 @@
 #include <gtest/gtest.h>
 
 #include "./status_optional.h"
+#include "./status_optional_static_message.h"
+#include "./status_optional_lazy_message.h"
+#include "./status_optional_cold_message.h"
+#include "./status_optional_pmr.h"
+#include "./status_optional_batch.h"
+#include "./status_optional_algorithm.h"
+#include "./status_optional_try.h"
+#include "./status_optional_coroutine.h"
+#include "./status_optional_warning_sink.h"
+#include "./status_optional_warning_list.h"
+#include "./status_optional_expected.h"
+#include "./status_optional_serialization.h"
+#include "./status_optional_reusable_message.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 struct Foo {
     int fizz;
@@ -61,3 +82,1894 @@ TEST(StatusOptional, BasicFunctionality) {
     ASSERT_EQ(base->buzz, base.value().buzz);
     ASSERT_EQ(warning->buzz, warning.value().buzz);
 }
+
+// Layout .
+namespace {
+
+template <typename T, typename MsgT>
+struct PayloadsWithDiscriminant {
+    T val;
+    MsgT msg;
+    unsigned char state;
+};
+
+template <typename MsgT>
+struct MessageWithDiscriminant {
+    MsgT msg;
+    unsigned char state;
+};
+
+}
+
+static_assert(sizeof(StatusOptional<int,int>) == sizeof(PayloadsWithDiscriminant<int,int>), "Unexpected StatusOptional size");
+static_assert(sizeof(StatusOptional<Foo,Bar>) == sizeof(PayloadsWithDiscriminant<Foo,Bar>), "Unexpected StatusOptional size");
+static_assert(sizeof(StatusOptional<Foo,std::string>) == sizeof(PayloadsWithDiscriminant<Foo,std::string>), "Unexpected StatusOptional size");
+static_assert(sizeof(StatusOptional<void,Bar>) == sizeof(MessageWithDiscriminant<Bar>), "Unexpected StatusOptional size");
+static_assert(sizeof(StatusOptional<void,std::string>) == sizeof(MessageWithDiscriminant<std::string>), "Unexpected StatusOptional size");
+
+static_assert(sizeof(StatusOptional<Foo,Bar>) < sizeof(std::optional<Foo>) + sizeof(std::optional<Bar>), "StatusOptional should be smaller than two optionals");
+static_assert(sizeof(StatusOptional<int,int>) < sizeof(std::optional<int>) + sizeof(std::optional<int>), "StatusOptional should be smaller than two optionals");
+static_assert(alignof(StatusOptional<Foo,Bar>) == alignof(PayloadsWithDiscriminant<Foo,Bar>), "Unexpected StatusOptional alignment");
+
+// Special members .
+namespace {
+
+enum class ErrCode {
+    Ok,
+    Failure
+};
+
+struct MoveOnly {
+    MoveOnly() = default;
+    MoveOnly(MoveOnly const&) = delete;
+    MoveOnly(MoveOnly &&) = default;
+    MoveOnly& operator=(MoveOnly const&) = delete;
+    MoveOnly& operator=(MoveOnly &&) = default;
+};
+
+struct ThrowingMove {
+    ThrowingMove() = default;
+    ThrowingMove(ThrowingMove const&) {}
+    ThrowingMove(ThrowingMove &&) {}
+    ThrowingMove& operator=(ThrowingMove const&) { return *this; }
+    ThrowingMove& operator=(ThrowingMove &&) { return *this; }
+};
+
+}
+
+static_assert(std::is_trivially_copyable_v<StatusOptional<int, ErrCode>>, "StatusOptional of trivial types should be trivially copyable");
+static_assert(std::is_trivially_copy_constructible_v<StatusOptional<int, ErrCode>>, "StatusOptional of trivial types should be trivially copy constructible");
+static_assert(std::is_trivially_move_constructible_v<StatusOptional<int, ErrCode>>, "StatusOptional of trivial types should be trivially move constructible");
+static_assert(std::is_trivially_copy_assignable_v<StatusOptional<int, ErrCode>>, "StatusOptional of trivial types should be trivially copy assignable");
+static_assert(std::is_trivially_move_assignable_v<StatusOptional<int, ErrCode>>, "StatusOptional of trivial types should be trivially move assignable");
+static_assert(std::is_trivially_destructible_v<StatusOptional<int, ErrCode>>, "StatusOptional of trivial types should be trivially destructible");
+static_assert(std::is_trivially_copyable_v<StatusOptional<void, ErrCode>>, "StatusOptional of trivial types should be trivially copyable");
+static_assert(std::is_trivially_destructible_v<StatusOptional<void, ErrCode>>, "StatusOptional of trivial types should be trivially destructible");
+
+static_assert(!std::is_trivially_copyable_v<StatusOptional<int, std::string>>, "StatusOptional of non trivial types cannot be trivially copyable");
+static_assert(!std::is_trivially_copyable_v<StatusOptional<void, std::string>>, "StatusOptional of non trivial types cannot be trivially copyable");
+
+static_assert(std::is_nothrow_move_constructible_v<StatusOptional<Foo, Bar>>, "StatusOptional should be nothrow move constructible when its payloads are");
+static_assert(std::is_nothrow_move_assignable_v<StatusOptional<Foo, Bar>>, "StatusOptional should be nothrow move assignable when its payloads are");
+static_assert(std::is_nothrow_move_constructible_v<StatusOptional<void, std::string>>, "StatusOptional should be nothrow move constructible when its payloads are");
+static_assert(std::is_nothrow_move_assignable_v<StatusOptional<void, std::string>>, "StatusOptional should be nothrow move assignable when its payloads are");
+static_assert(!std::is_nothrow_copy_constructible_v<StatusOptional<Foo, Bar>>, "StatusOptional copy might allocate");
+
+static_assert(!std::is_nothrow_move_constructible_v<StatusOptional<ThrowingMove, ErrCode>>, "StatusOptional move should not be noexcept when the value move is not");
+static_assert(!std::is_nothrow_move_constructible_v<StatusOptional<int, ThrowingMove>>, "StatusOptional move should not be noexcept when the message move is not");
+static_assert(!std::is_nothrow_move_assignable_v<StatusOptional<void, ThrowingMove>>, "StatusOptional move should not be noexcept when the message move is not");
+
+static_assert(!std::is_copy_constructible_v<StatusOptional<MoveOnly, ErrCode>>, "StatusOptional of move only types should not be copyable");
+static_assert(!std::is_copy_assignable_v<StatusOptional<MoveOnly, ErrCode>>, "StatusOptional of move only types should not be copyable");
+static_assert(std::is_nothrow_move_constructible_v<StatusOptional<MoveOnly, ErrCode>>, "StatusOptional of move only types should be movable");
+static_assert(std::is_nothrow_move_assignable_v<StatusOptional<MoveOnly, ErrCode>>, "StatusOptional of move only types should be movable");
+static_assert(!std::is_copy_constructible_v<StatusOptional<void, MoveOnly>>, "StatusOptional of move only types should not be copyable");
+static_assert(std::is_move_constructible_v<StatusOptional<void, MoveOnly>>, "StatusOptional of move only types should be movable");
+
+TEST(StatusOptional, VectorReallocationMoves) {
+    std::vector<StatusOptional<Foo, Bar>> results;
+    results.push_back(StatusOptional<Foo,Bar>::error(Bar{"Something has definitly gone wrong, and the message is too long for small string optimization", 27}));
+    char const* msgData = results.front().message().fizz.data();
+    for (int i = 0; i < 64; i++) {
+        results.push_back(Foo{i, "everything is nice"});
+    }
+    ASSERT_TRUE(results.front().is_error());
+    ASSERT_EQ(results.front().message().fizz.data(), msgData);
+}
+
+// Copy and move .
+namespace {
+
+template <typename SO>
+void expectSameState(SO const& a, SO const& b) {
+    EXPECT_EQ(a.is_valid(), b.is_valid());
+    EXPECT_EQ(a.is_no_error_or_warning(), b.is_no_error_or_warning());
+    EXPECT_EQ(a.is_warning(), b.is_warning());
+    EXPECT_EQ(a.is_error(), b.is_error());
+    EXPECT_EQ(a.has_message(), b.has_message());
+    if (a.has_message() and b.has_message()) {
+        EXPECT_EQ(a.message(), b.message());
+    }
+}
+
+template <typename SO>
+void checkCopyAndMove(SO const& reference) {
+    ASSERT_NO_THROW({
+        SO copied(reference);
+        expectSameState(copied, reference);
+
+        SO copyAssigned;
+        copyAssigned = reference;
+        expectSameState(copyAssigned, reference);
+
+        SO moved(std::move(copied));
+        expectSameState(moved, reference);
+
+        SO moveAssigned = SO::error("Overwritten by a move");
+        moveAssigned = std::move(moved);
+        expectSameState(moveAssigned, reference);
+    });
+}
+
+}
+
+TEST(StatusOptional, CopyAndMoveEveryState) {
+    using SO = StatusOptional<std::string, std::string>;
+
+    std::vector<SO> states = {
+        SO(),
+        SO(std::string("everything is nice")),
+        SO::warning(std::string("everything should be nice"), std::string("Something may have gone wrong")),
+        SO::error(std::string("Something has definitly gone wrong"))
+    };
+
+    for (SO const& state : states) {
+        checkCopyAndMove(state);
+        SO copied(state);
+        if (state.has_value()) {
+            EXPECT_EQ(copied.value(), state.value());
+        } else {
+            EXPECT_ANY_THROW(copied.value());
+        }
+    }
+
+    SO value(std::string("everything is nice"));
+    SO moved(std::move(value));
+    ASSERT_TRUE(moved.is_no_error_or_warning());
+    ASSERT_EQ(moved.value(), std::string("everything is nice"));
+}
+
+TEST(StatusOptional, CopyAndMoveEveryStateVoid) {
+    using SO = StatusOptional<void, std::string>;
+
+    // default constructed StatusOptional<void, MsgT> are valid, not invalid.
+    std::vector<SO> states = {
+        SO(),
+        SO::warning(std::string("Something may have gone wrong")),
+        SO::error(std::string("Something has definitly gone wrong"))
+    };
+
+    for (SO const& state : states) {
+        checkCopyAndMove(state);
+    }
+
+    SO error = SO::error(std::string("Something has definitly gone wrong"));
+    SO moved(std::move(error));
+    ASSERT_TRUE(moved.is_error());
+    ASSERT_EQ(moved.message(), std::string("Something has definitly gone wrong"));
+}
+
+// In place construction .
+namespace {
+
+struct ConstructionCounter {
+    static int constructions;
+
+    ConstructionCounter(int a, std::string b) :
+        fizz(a),
+        buzz(std::move(b))
+    {
+        constructions++;
+    }
+
+    ConstructionCounter(ConstructionCounter const& other) :
+        fizz(other.fizz),
+        buzz(other.buzz)
+    {
+        constructions++;
+    }
+
+    ConstructionCounter(ConstructionCounter && other) :
+        fizz(other.fizz),
+        buzz(std::move(other.buzz))
+    {
+        constructions++;
+    }
+
+    int fizz;
+    std::string buzz;
+};
+
+int ConstructionCounter::constructions = 0;
+
+}
+
+TEST(StatusOptional, InPlaceConstruction) {
+    using SO = StatusOptional<ConstructionCounter, ConstructionCounter>;
+
+    ConstructionCounter::constructions = 0;
+    SO value(std::in_place, 69, "everything is nice");
+    ASSERT_EQ(ConstructionCounter::constructions, 1);
+    ASSERT_TRUE(value.is_no_error_or_warning());
+    ASSERT_EQ(value->fizz, 69);
+
+    ConstructionCounter::constructions = 0;
+    SO warning = SO::warning_in_place(std::piecewise_construct,
+                                      std::forward_as_tuple(33, "everything should be nice"),
+                                      std::forward_as_tuple(42, "Something may have gone wrong"));
+    ASSERT_EQ(ConstructionCounter::constructions, 2);
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning->fizz, 33);
+    ASSERT_EQ(warning.message().buzz, std::string("Something may have gone wrong"));
+
+    ConstructionCounter::constructions = 0;
+    SO error = SO::error_in_place(27, "Something has definitly gone wrong");
+    ASSERT_EQ(ConstructionCounter::constructions, 1);
+    ASSERT_TRUE(error.is_error());
+    ASSERT_EQ(error.message().fizz, 27);
+
+    ConstructionCounter::constructions = 0;
+    ConstructionCounter& emplaced = error.emplace_value(12, "replaced");
+    ASSERT_EQ(ConstructionCounter::constructions, 1);
+    ASSERT_TRUE(error.is_no_error_or_warning());
+    ASSERT_EQ(&emplaced, &error.value());
+    ASSERT_EQ(emplaced.buzz, std::string("replaced"));
+
+    using VoidSO = StatusOptional<void, ConstructionCounter>;
+
+    ConstructionCounter::constructions = 0;
+    VoidSO voidWarning = VoidSO::warning_in_place(42, "Something may have gone wrong");
+    VoidSO voidError = VoidSO::error_in_place(27, "Something has definitly gone wrong");
+    ASSERT_EQ(ConstructionCounter::constructions, 2);
+    ASSERT_TRUE(voidWarning.is_warning());
+    ASSERT_TRUE(voidError.is_error());
+    ASSERT_EQ(voidError.message().fizz, 27);
+}
+
+// Monadic operations .
+TEST(StatusOptional, MonadicOperations) {
+    using SO = StatusOptional<int, std::string>;
+
+    auto half = [] (int v) {
+        if (v % 2 != 0) {
+            return StatusOptional<int, std::string>::error("odd value");
+        }
+        return StatusOptional<int, std::string>(v/2);
+    };
+
+    SO value(8);
+    SO warning = SO::warning(4, std::string("approximated"));
+    SO error = SO::error(std::string("no value"));
+    SO invalid;
+
+    ASSERT_EQ(value.and_then(half).value(), 4);
+    ASSERT_TRUE(value.and_then(half).and_then(half).and_then(half).and_then(half).is_error());
+    ASSERT_EQ(value.and_then(half).and_then(half).and_then(half).and_then(half).message(), std::string("odd value"));
+    ASSERT_TRUE(warning.and_then(half).is_warning());
+    ASSERT_EQ(warning.and_then(half).message(), std::string("approximated"));
+    ASSERT_EQ(error.and_then(half).message(), std::string("no value"));
+    ASSERT_FALSE(invalid.and_then(half).is_valid());
+
+    auto toString = [] (int v) { return std::to_string(v); };
+
+    StatusOptional<std::string, std::string> transformed = warning.transform(toString);
+    ASSERT_TRUE(transformed.is_warning());
+    ASSERT_EQ(transformed.value(), std::string("4"));
+    ASSERT_EQ(transformed.message(), std::string("approximated"));
+    ASSERT_TRUE(value.transform(toString).is_no_error_or_warning());
+    ASSERT_TRUE(error.transform(toString).is_error());
+    ASSERT_FALSE(invalid.transform(toString).is_valid());
+
+    int sideEffect = 0;
+    StatusOptional<void, std::string> voidTransformed = warning.transform([&sideEffect] (int v) { sideEffect = v; });
+    ASSERT_EQ(sideEffect, 4);
+    ASSERT_TRUE(voidTransformed.is_warning());
+    ASSERT_FALSE(invalid.transform([] (int) {}).is_valid());
+
+    auto recover = [] (std::string const&) { return StatusOptional<int, std::string>(0); };
+    ASSERT_EQ(error.or_else(recover).value(), 0);
+    ASSERT_TRUE(warning.or_else(recover).is_warning());
+    ASSERT_EQ(value.or_else(recover).value(), 8);
+
+    auto length = [] (std::string const& msg) { return msg.size(); };
+    StatusOptional<int, std::size_t> lengthError = error.transform_error(length);
+    ASSERT_TRUE(lengthError.is_error());
+    ASSERT_EQ(lengthError.message(), std::string("no value").size());
+    ASSERT_TRUE(warning.transform_error(length).is_warning());
+    ASSERT_EQ(warning.transform_error(length).value(), 4);
+    ASSERT_TRUE(value.transform_error(length).is_no_error_or_warning());
+    ASSERT_FALSE(invalid.transform_error(length).is_valid());
+}
+
+TEST(StatusOptional, MonadicOperationsMoveRvalues) {
+    using SO = StatusOptional<std::string, std::string>;
+
+    std::string longValue = "a value long enough to defeat the small string optimization of std::string";
+    std::string longMessage = "a message long enough to defeat the small string optimization of std::string";
+
+    SO warning = SO::warning(longValue, longMessage);
+    char const* valueData = warning.value().data();
+    char const* msgData = warning.message().data();
+
+    SO chained = std::move(warning)
+            .transform([] (std::string && v) { return std::move(v); })
+            .and_then([] (std::string && v) { return SO(std::move(v)); });
+
+    ASSERT_TRUE(chained.is_warning());
+    ASSERT_EQ(chained.value().data(), valueData);
+    ASSERT_EQ(chained.message().data(), msgData);
+
+    SO error = SO::error(longMessage);
+    msgData = error.message().data();
+    StatusOptional<int, std::string> converted = std::move(error).transform([] (std::string &&) { return 0; });
+    ASSERT_TRUE(converted.is_error());
+    ASSERT_EQ(converted.message().data(), msgData);
+}
+
+TEST(StatusOptional, MonadicOperationsVoid) {
+    using SO = StatusOptional<void, std::string>;
+
+    SO ok;
+    SO warning = SO::warning(std::string("approximated"));
+    SO error = SO::error(std::string("failed"));
+
+    auto next = [] () { return StatusOptional<int, std::string>(42); };
+
+    ASSERT_EQ(ok.and_then(next).value(), 42);
+    ASSERT_TRUE(warning.and_then(next).is_warning());
+    ASSERT_EQ(warning.and_then(next).message(), std::string("approximated"));
+    ASSERT_TRUE(error.and_then(next).is_error());
+
+    ASSERT_EQ(ok.transform([] () { return 3; }).value(), 3);
+    ASSERT_TRUE(warning.transform([] () { return 3; }).is_warning());
+    ASSERT_TRUE(error.transform([] () { return 3; }).is_error());
+    ASSERT_TRUE(warning.transform([] () {}).is_warning());
+
+    ASSERT_TRUE(error.or_else([] (std::string const&) { return SO(); }).is_no_error_or_warning());
+    ASSERT_TRUE(warning.or_else([] (std::string const&) { return SO(); }).is_warning());
+
+    StatusOptional<void, std::size_t> lengthError = error.transform_error([] (std::string const& msg) { return msg.size(); });
+    ASSERT_TRUE(lengthError.is_error());
+    ASSERT_EQ(lengthError.message(), std::string("failed").size());
+    ASSERT_TRUE(ok.transform_error([] (std::string const& msg) { return msg.size(); }).is_no_error_or_warning());
+}
+
+// Constant expressions .
+namespace {
+
+using ConstexprSO = StatusOptional<int, ErrCode>;
+
+constexpr ConstexprSO constexprInvalid;
+constexpr ConstexprSO constexprValue = 42;
+constexpr ConstexprSO constexprWarning = ConstexprSO::warning(33, ErrCode::Failure);
+constexpr ConstexprSO constexprError = ConstexprSO::error(ErrCode::Failure);
+constexpr ConstexprSO constexprInPlace = ConstexprSO::warning_in_place(std::piecewise_construct, std::make_tuple(12), std::make_tuple(ErrCode::Ok));
+
+static_assert(!constexprInvalid.is_valid(), "Unexpected constexpr state");
+static_assert(!constexprInvalid.has_value() and !constexprInvalid.has_message(), "Unexpected constexpr state");
+static_assert(constexprInvalid.value_or(7) == 7, "Unexpected constexpr value_or");
+
+static_assert(constexprValue.is_no_error_or_warning(), "Unexpected constexpr state");
+static_assert(constexprValue, "Unexpected constexpr state");
+static_assert(constexprValue.value() == 42, "Unexpected constexpr value");
+static_assert(constexprValue.value_or(7) == 42, "Unexpected constexpr value_or");
+
+static_assert(constexprWarning.is_warning(), "Unexpected constexpr state");
+static_assert(constexprWarning.value() == 33, "Unexpected constexpr value");
+static_assert(constexprWarning.message() == ErrCode::Failure, "Unexpected constexpr message");
+
+static_assert(constexprError.is_error(), "Unexpected constexpr state");
+static_assert(!constexprError, "Unexpected constexpr state");
+static_assert(constexprError.message() == ErrCode::Failure, "Unexpected constexpr message");
+static_assert(constexprError.value_or(7) == 7, "Unexpected constexpr value_or");
+
+static_assert(constexprInPlace.is_warning() and constexprInPlace.value() == 12, "Unexpected constexpr state");
+static_assert(ConstexprSO(std::in_place, 5).value() == 5, "Unexpected constexpr value");
+static_assert(ConstexprSO::error_in_place(ErrCode::Ok).is_error(), "Unexpected constexpr state");
+
+using ConstexprVoidSO = StatusOptional<void, ErrCode>;
+
+static_assert(ConstexprVoidSO().is_no_error_or_warning(), "Unexpected constexpr state");
+static_assert(ConstexprVoidSO::warning(ErrCode::Failure).is_warning(), "Unexpected constexpr state");
+static_assert(ConstexprVoidSO::error(ErrCode::Failure).is_error(), "Unexpected constexpr state");
+static_assert(ConstexprVoidSO::error_in_place(ErrCode::Failure).message() == ErrCode::Failure, "Unexpected constexpr message");
+
+constexpr ConstexprSO parseDigit(char c) {
+    if (c < '0' or c > '9') {
+        return ConstexprSO::error(ErrCode::Failure);
+    }
+    return c - '0';
+}
+
+constexpr int sumDigits(char const* str) {
+    int sum = 0;
+    for (; *str != '\0'; str++) {
+        ConstexprSO digit = parseDigit(*str);
+        sum += digit.value_or(0);
+    }
+    return sum;
+}
+
+static_assert(parseDigit('7').value() == 7, "Unexpected constexpr parse");
+static_assert(parseDigit('x').is_error(), "Unexpected constexpr parse");
+static_assert(sumDigits("1a2b3") == 6, "Unexpected constexpr parse");
+
+}
+
+// Fallback values .
+TEST(StatusOptional, ValueOr) {
+    using SO = StatusOptional<std::string, std::string>;
+
+    std::string longValue = "a value long enough to defeat the small string optimization of std::string";
+
+    SO value(longValue);
+    SO error = SO::error(std::string("no value"));
+
+    ASSERT_EQ(value.value_or("fallback"), longValue);
+    ASSERT_EQ(error.value_or("fallback"), std::string("fallback"));
+    ASSERT_EQ(error.value_or({"fallback", 4}), std::string("fall"));
+
+    char const* valueData = value.value().data();
+    std::string moved = std::move(value).value_or("fallback");
+    ASSERT_EQ(moved.data(), valueData);
+
+    int fallbackBuilt = 0;
+    auto fallback = [&fallbackBuilt] () {
+        fallbackBuilt++;
+        return std::string("fallback");
+    };
+
+    SO other(longValue);
+    ASSERT_EQ(other.value_or_else(fallback), longValue);
+    ASSERT_EQ(fallbackBuilt, 0);
+    ASSERT_EQ(error.value_or_else(fallback), std::string("fallback"));
+    ASSERT_EQ(fallbackBuilt, 1);
+
+    valueData = other.value().data();
+    moved = std::move(other).value_or_else(fallback);
+    ASSERT_EQ(moved.data(), valueData);
+    ASSERT_EQ(fallbackBuilt, 1);
+}
+
+static_assert(ConstexprSO(3).value_or_else([] () { return 0; }) == 3, "Unexpected constexpr value_or_else");
+
+// Static messages .
+namespace {
+
+char const* describeParseCode(int code) {
+    switch (code) {
+    case 1:
+        return "unexpected token";
+    case 2:
+        return "unexpected end of input";
+    default:
+        return "unknown parse error";
+    }
+}
+
+constexpr StatusCategory parseCategory("parse", &describeParseCode);
+
+constexpr StatusOptional<int, StaticMessage> staticMessageError = StatusOptional<int, StaticMessage>::error("Something has definitly gone wrong");
+constexpr StatusOptional<void, StatusCode> statusCodeError = StatusOptional<void, StatusCode>::error(StatusCode(2, parseCategory));
+
+static_assert(staticMessageError.is_error(), "Unexpected constexpr state");
+static_assert(staticMessageError.message() == StaticMessage("Something has definitly gone wrong"), "Unexpected constexpr message");
+static_assert(staticMessageError.message().size() == 34, "Unexpected constexpr message size");
+static_assert(statusCodeError.is_error(), "Unexpected constexpr state");
+static_assert(statusCodeError.message().code() == 2, "Unexpected constexpr code");
+static_assert(statusCodeError.message().category() == &parseCategory, "Unexpected constexpr category");
+
+static_assert(std::is_trivially_copyable_v<StaticMessage>, "StaticMessage should be trivially copyable");
+static_assert(std::is_trivially_copyable_v<StatusCode>, "StatusCode should be trivially copyable");
+static_assert(std::is_trivially_copyable_v<StatusOptional<int, StaticMessage>>, "StatusOptional of static messages should be trivially copyable");
+static_assert(std::is_trivially_copyable_v<StatusOptional<void, StaticMessage>>, "StatusOptional of static messages should be trivially copyable");
+static_assert(std::is_trivially_copyable_v<StatusOptional<int, StatusCode>>, "StatusOptional of status codes should be trivially copyable");
+static_assert(std::is_trivially_copyable_v<StatusOptional<void, StatusCode>>, "StatusOptional of status codes should be trivially copyable");
+
+}
+
+TEST(StatusOptional, StaticMessages) {
+    StatusOptional<int, StaticMessage> warning = StatusOptional<int, StaticMessage>::warning(3, "approximated");
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.message().view(), std::string_view("approximated"));
+    ASSERT_STREQ(warning.message().c_str(), "approximated");
+
+    StatusOptional<void, StaticMessage> voidError = StatusOptional<void, StaticMessage>::error("failed");
+    ASSERT_TRUE(voidError.is_error());
+    ASSERT_EQ(voidError.message().view(), std::string_view("failed"));
+
+    StatusOptional<int, StatusCode> codeError = StatusOptional<int, StatusCode>::error(StatusCode(1, parseCategory));
+    StatusOptional<int, StatusCode> copied = codeError;
+    ASSERT_TRUE(copied.is_error());
+    ASSERT_EQ(copied.message(), StatusCode(1, parseCategory));
+    ASSERT_NE(copied.message(), StatusCode(2, parseCategory));
+    ASSERT_STREQ(copied.message().message(), "unexpected token");
+    ASSERT_STREQ(copied.message().category()->name(), "parse");
+    ASSERT_STREQ(StatusCode().message(), "");
+}
+
+// Lazy messages .
+TEST(StatusOptional, LazyMessages) {
+    using SO = StatusOptional<int, LazyMessage<std::string>>;
+
+    int formatted = 0;
+    int offset = 42;
+    auto formatter = [&formatted, offset] () {
+        formatted++;
+        return std::string("Padding at offset ") + std::to_string(offset);
+    };
+
+    SO warning = SO::warning(3, formatter);
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.value(), 3);
+
+    SO copied = warning;
+    SO moved = std::move(copied);
+    ASSERT_TRUE(moved.is_warning());
+    ASSERT_EQ(formatted, 0);
+
+    static_assert(std::is_same_v<std::decay_t<decltype(warning.message())>, std::string>, "Unexpected function return type");
+    ASSERT_EQ(warning.message(), std::string("Padding at offset 42"));
+    ASSERT_EQ(formatted, 1);
+    ASSERT_EQ(warning.message(), std::string("Padding at offset 42"));
+    ASSERT_EQ(formatted, 1);
+
+    SO const& constMoved = moved;
+    ASSERT_EQ(constMoved.message(), std::string("Padding at offset 42"));
+    ASSERT_EQ(formatted, 2);
+
+    SO error = SO::error("Something has definitly gone wrong");
+    ASSERT_EQ(error.message(), std::string("Something has definitly gone wrong"));
+
+    StatusOptional<int, std::size_t> length = SO::error([] () { return std::string("deferred"); })
+            .transform_error([] (std::string && msg) { return msg.size(); });
+    ASSERT_TRUE(length.is_error());
+    ASSERT_EQ(length.message(), std::string("deferred").size());
+
+    using VoidSO = StatusOptional<void, LazyMessage<std::string>>;
+    VoidSO voidWarning = VoidSO::warning(formatter);
+    ASSERT_EQ(formatted, 2);
+    ASSERT_EQ(voidWarning.message(), std::string("Padding at offset 42"));
+    ASSERT_EQ(formatted, 3);
+
+    // formatters which cannot be copied are run when the message is copied.
+    LazyMessage<std::string> moveOnly([id = std::make_unique<int>(7)] () { return std::to_string(*id); });
+    ASSERT_FALSE(moveOnly.is_resolved());
+    LazyMessage<std::string> moveOnlyCopy = moveOnly;
+    ASSERT_TRUE(moveOnly.is_resolved());
+    ASSERT_EQ(moveOnlyCopy.get(), std::string("7"));
+}
+
+// Cold messages .
+namespace {
+
+struct DiagnosticReport {
+    int line;
+    int column;
+    char excerpt[192];
+};
+
+static_assert(sizeof(StatusOptional<int, ColdMessage<DiagnosticReport>>) == sizeof(PayloadsWithDiscriminant<int, DiagnosticReport*>), "Unexpected StatusOptional size");
+static_assert(sizeof(StatusOptional<void, ColdMessage<DiagnosticReport>>) == sizeof(MessageWithDiscriminant<DiagnosticReport*>), "Unexpected StatusOptional size");
+static_assert(std::is_nothrow_move_constructible_v<StatusOptional<int, ColdMessage<DiagnosticReport>>>, "StatusOptional of cold messages should be nothrow movable");
+
+}
+
+TEST(StatusOptional, ColdMessages) {
+    using SO = StatusOptional<int, ColdMessage<DiagnosticReport>>;
+
+    SO value = 42;
+    ASSERT_TRUE(value.is_no_error_or_warning());
+
+    SO warning = SO::warning(3, DiagnosticReport{12, 4, "int x = ;"});
+    static_assert(std::is_same_v<std::decay_t<decltype(warning.message())>, DiagnosticReport>, "Unexpected function return type");
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.message().line, 12);
+    ASSERT_STREQ(warning.message().excerpt, "int x = ;");
+
+    SO copied = warning;
+    ASSERT_NE(&copied.message(), &warning.message());
+    ASSERT_EQ(copied.message().column, 4);
+
+    DiagnosticReport const* report = &warning.message();
+    SO moved = std::move(warning);
+    ASSERT_EQ(&moved.message(), report);
+
+    SO error = SO::error_in_place(std::in_place, DiagnosticReport{7, 1, "}"});
+    ASSERT_TRUE(error.is_error());
+    ASSERT_EQ(error.message().line, 7);
+
+    error = copied;
+    ASSERT_TRUE(error.is_warning());
+    ASSERT_EQ(error.message().line, 12);
+
+    StatusOptional<void, ColdMessage<DiagnosticReport>> voidError = StatusOptional<void, ColdMessage<DiagnosticReport>>::error(DiagnosticReport{1, 1, ""});
+    ASSERT_TRUE(voidError.is_error());
+    ASSERT_EQ(voidError.message().line, 1);
+}
+
+// Allocator aware construction .
+TEST(StatusOptional, AllocatorAwareConstruction) {
+    using SO = pmr::StatusOptional<std::pmr::vector<int>>;
+
+    static_assert(std::is_same_v<SO::MessageType, std::pmr::string>, "Unexpected pmr message type");
+
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::polymorphic_allocator<char> alloc(&arena);
+
+    std::string longMessage = "a message long enough to defeat the small string optimization of std::string";
+
+    SO error = SO::error(std::allocator_arg, alloc, longMessage);
+    ASSERT_TRUE(error.is_error());
+    ASSERT_EQ(error.message(), std::pmr::string(longMessage));
+    ASSERT_EQ(error.message().get_allocator().resource(), &arena);
+
+    SO warning = SO::warning(std::allocator_arg, alloc, std::pmr::vector<int>{1, 2, 3}, longMessage.c_str(), 10);
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.value().size(), 3);
+    ASSERT_EQ(warning.value().get_allocator().resource(), &arena);
+    ASSERT_EQ(warning.message(), std::pmr::string(longMessage.c_str(), 10));
+    ASSERT_EQ(warning.message().get_allocator().resource(), &arena);
+
+    SO value(std::allocator_arg, alloc, std::in_place, std::size_t(4), 7);
+    ASSERT_TRUE(value.is_no_error_or_warning());
+    ASSERT_EQ(value.value().size(), 4);
+    ASSERT_EQ(value.value().get_allocator().resource(), &arena);
+
+    std::pmr::monotonic_buffer_resource otherArena;
+    SO copied(std::allocator_arg, std::pmr::polymorphic_allocator<char>(&otherArena), warning);
+    ASSERT_TRUE(copied.is_warning());
+    ASSERT_EQ(copied.value().get_allocator().resource(), &otherArena);
+    ASSERT_EQ(copied.message().get_allocator().resource(), &otherArena);
+
+    using VoidSO = pmr::StatusOptional<void>;
+    VoidSO voidError = VoidSO::error(std::allocator_arg, alloc, longMessage);
+    ASSERT_TRUE(voidError.is_error());
+    ASSERT_EQ(voidError.message().get_allocator().resource(), &arena);
+    VoidSO voidMoved(std::allocator_arg, alloc, std::move(voidError));
+    ASSERT_TRUE(voidMoved.is_error());
+    ASSERT_EQ(voidMoved.message().get_allocator().resource(), &arena);
+
+    // types without allocator ignore it.
+    StatusOptional<int, int> plain = StatusOptional<int, int>::error(std::allocator_arg, alloc, 3);
+    ASSERT_EQ(plain.message(), 3);
+}
+
+// Niche optimization .
+namespace {
+
+struct Entry {
+    int id;
+};
+
+enum class Code64 : std::int64_t {
+    None = 0,
+    Truncated = 1,
+    Corrupted = 2
+};
+
+struct Handle {
+    int id;
+
+    constexpr bool operator==(Handle const& other) const {
+        return id == other.id;
+    }
+};
+
+}
+
+template <>
+struct status_optional_niche<Entry*> : status_optional_sentinel_niche<Entry*, nullptr> {};
+
+template <>
+struct status_optional_niche<Code64> : status_optional_sentinel_niche<Code64, Code64::None> {};
+
+template <>
+struct status_optional_niche<Handle> {
+    static constexpr bool available = true;
+
+    static constexpr Handle empty() noexcept {
+        return Handle{-1};
+    }
+
+    static constexpr bool is_empty(Handle const& handle) noexcept {
+        return handle.id == -1;
+    }
+};
+
+template <>
+struct status_optional_niche<double> : status_optional_nan_niche<double> {};
+
+namespace {
+
+static_assert(sizeof(StatusOptional<Entry*, Code64>) == sizeof(Entry*) + sizeof(Code64), "Niche StatusOptional should not store a discriminant");
+static_assert(sizeof(StatusOptional<Entry*, ErrCode>) == sizeof(PayloadsWithDiscriminant<Entry*, ErrCode>), "StatusOptional needs a discriminant when the message has no niche");
+static_assert(sizeof(StatusOptional<Handle, Handle>) == 2*sizeof(int), "Niche StatusOptional should not store a discriminant");
+static_assert(sizeof(StatusOptional<double, Code64>) == 2*sizeof(double), "Niche StatusOptional should not store a discriminant");
+static_assert(sizeof(StatusOptional<void, Code64>) == sizeof(MessageWithDiscriminant<Code64>), "StatusOptional<void, MsgT> needs a discriminant to tell valid from invalid");
+static_assert(std::is_trivially_copyable_v<StatusOptional<Entry*, Code64>>, "Niche StatusOptional of trivial types should be trivially copyable");
+static_assert(std::is_trivially_destructible_v<StatusOptional<Entry*, Code64>>, "Niche StatusOptional of trivial types should be trivially destructible");
+
+using NicheSO = StatusOptional<Handle, Code64>;
+
+static_assert(!NicheSO().is_valid() and !NicheSO().has_message(), "Unexpected constexpr state");
+static_assert(NicheSO(Handle{3}).is_no_error_or_warning(), "Unexpected constexpr state");
+static_assert(NicheSO::warning(Handle{3}, Code64::Truncated).is_warning(), "Unexpected constexpr state");
+static_assert(NicheSO::error(Code64::Corrupted).is_error(), "Unexpected constexpr state");
+static_assert(NicheSO::error(Code64::Corrupted).value_or(Handle{0}).id == 0, "Unexpected constexpr value_or");
+
+}
+
+TEST(StatusOptional, NicheOptimization) {
+    using SO = StatusOptional<Entry*, Code64>;
+
+    Entry entry{5};
+
+    SO invalid;
+    ASSERT_FALSE(invalid.is_valid());
+    ASSERT_FALSE(invalid.has_message());
+
+    SO value = &entry;
+    ASSERT_TRUE(value.is_no_error_or_warning());
+    ASSERT_EQ(value.value()->id, 5);
+
+    SO warning = SO::warning(&entry, Code64::Truncated);
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.message(), Code64::Truncated);
+
+    SO error = SO::error(Code64::Corrupted);
+    ASSERT_TRUE(error.is_error());
+    ASSERT_THROW(error.value(), std::bad_optional_access);
+
+    SO copied = warning;
+    ASSERT_TRUE(copied.is_warning());
+    copied = error;
+    ASSERT_TRUE(copied.is_error());
+    ASSERT_EQ(copied.message(), Code64::Corrupted);
+    copied = value;
+    ASSERT_TRUE(copied.is_no_error_or_warning());
+    ASSERT_EQ(copied.value(), &entry);
+
+    SO transformed = warning.and_then([] (Entry* e) { return SO::error(e->id == 5 ? Code64::Corrupted : Code64::Truncated); });
+    ASSERT_TRUE(transformed.is_error());
+    ASSERT_EQ(transformed.message(), Code64::Corrupted);
+
+    StatusOptional<Handle, Code64> handle = error.transform([] (Entry* e) { return Handle{e->id}; });
+    ASSERT_TRUE(handle.is_error());
+    handle = value.transform([] (Entry* e) { return Handle{e->id}; });
+    ASSERT_TRUE(handle.is_no_error_or_warning());
+    ASSERT_EQ(handle.value().id, 5);
+
+    StatusOptional<double, Code64> ratio = 0.5;
+    ASSERT_TRUE(ratio.is_no_error_or_warning());
+    ratio = std::numeric_limits<double>::quiet_NaN();
+    ASSERT_TRUE(ratio.is_no_error_or_warning());
+    ratio = StatusOptional<double, Code64>::error(Code64::Truncated);
+    ASSERT_FALSE(ratio.has_value());
+    ASSERT_TRUE(ratio.is_error());
+}
+
+// Batches .
+TEST(StatusOptional, Batch) {
+    using SO = StatusOptional<int, std::string>;
+    using Batch = StatusOptionalBatch<int, std::string>;
+
+    Batch batch;
+    ASSERT_TRUE(batch.empty());
+
+    for (int i = 0; i < 200; i++) {
+        if (i % 50 == 7) {
+            batch.push_back(SO::error("error " + std::to_string(i)));
+        } else if (i % 40 == 3) {
+            batch.push_warning(i, "warning " + std::to_string(i));
+        } else if (i == 150) {
+            batch.push_invalid();
+        } else {
+            batch.push_back(SO(i));
+        }
+    }
+
+    ASSERT_EQ(batch.size(), 200);
+    ASSERT_EQ(batch.word_count(), 4);
+    ASSERT_EQ(batch.count_errors(), 4);
+    ASSERT_EQ(batch.count_warnings(), 5);
+    ASSERT_EQ(batch.count_valid(), 195);
+
+    ASSERT_TRUE(batch[0].is_no_error_or_warning());
+    ASSERT_EQ(batch[0].value(), 0);
+
+    ASSERT_TRUE(batch[57].is_error());
+    ASSERT_EQ(batch[57].message(), "error 57");
+    ASSERT_TRUE(batch[57].is_valid());
+    ASSERT_THROW(batch[57].value(), std::bad_optional_access);
+    ASSERT_EQ(batch[57].value_or(-1), -1);
+
+    ASSERT_TRUE(batch[83].is_warning());
+    ASSERT_EQ(batch[83].value(), 83);
+    ASSERT_EQ(batch[83].message(), "warning 83");
+
+    ASSERT_FALSE(batch[150].is_valid());
+    ASSERT_FALSE(batch[150].has_message());
+    ASSERT_THROW(batch[150].message(), std::bad_optional_access);
+    ASSERT_THROW(batch[56].message(), std::bad_optional_access);
+    ASSERT_EQ(batch[83].unchecked_message(), "warning 83");
+
+    SO warning = batch[123];
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.value(), 123);
+    ASSERT_EQ(warning.message(), "warning 123");
+    SO error = batch[107];
+    ASSERT_TRUE(error.is_error());
+    ASSERT_EQ(error.message(), "error 107");
+
+    int sum = 0;
+    std::size_t count = 0;
+    for (auto it = batch.valid_values().begin(); it != batch.valid_values().end(); ++it) {
+        ASSERT_EQ(*it, static_cast<int>(it.index()));
+        sum += *it;
+        count++;
+    }
+    ASSERT_EQ(count, batch.count_valid());
+
+    int forEachSum = 0;
+    batch.for_each_valid([&forEachSum] (std::size_t index, int value) {
+        ASSERT_EQ(value, static_cast<int>(index));
+        forEachSum += value;
+    });
+    ASSERT_EQ(forEachSum, sum);
+
+    SO moved = SO::warning(1, std::string(64, 'x'));
+    batch.push_back(std::move(moved));
+    ASSERT_EQ(batch[200].message(), std::string(64, 'x'));
+
+    batch.clear();
+    ASSERT_EQ(batch.size(), 0);
+    ASSERT_EQ(batch.count_valid(), 0);
+    ASSERT_TRUE(batch.valid_values().begin() == batch.valid_values().end());
+}
+
+TEST(StatusOptional, BatchScans) {
+    using Batch = StatusOptionalBatch<int, int>;
+
+    Batch empty;
+    ASSERT_TRUE(empty.all_ok());
+    ASSERT_FALSE(empty.any_error());
+    ASSERT_EQ(empty.first_error_index(), 0);
+
+    // sizes around the word and vector block boundaries, with a single error or warning at every position of interest.
+    for (std::size_t size : {1, 63, 64, 65, 200, 256, 257, 1000}) {
+        for (std::size_t special : {std::size_t(0), size / 2, size - 1, size}) {
+            Batch errors;
+            Batch warnings;
+            for (std::size_t i = 0; i < size; i++) {
+                if (i == special) {
+                    errors.push_error(1);
+                    warnings.push_warning(int(i), 1);
+                } else {
+                    errors.push_value(int(i));
+                    warnings.push_value(int(i));
+                }
+            }
+
+            bool hasSpecial = special < size;
+            ASSERT_EQ(errors.any_error(), hasSpecial);
+            ASSERT_EQ(errors.first_error_index(), hasSpecial ? special : size);
+            ASSERT_EQ(errors.all_ok(), !hasSpecial);
+            ASSERT_FALSE(warnings.any_error());
+            ASSERT_EQ(warnings.first_error_index(), size);
+            ASSERT_EQ(warnings.all_ok(), !hasSpecial);
+        }
+    }
+
+    Batch mixed;
+    for (int i = 0; i < 300; i++) {
+        switch (i % 7) {
+        case 0:
+            mixed.push_error(i);
+            break;
+        case 1:
+            mixed.push_warning(i, i);
+            break;
+        case 2:
+            mixed.push_invalid();
+            break;
+        default:
+            mixed.push_value(i);
+        }
+    }
+
+    Batch::Partition partition = mixed.partition_by_state();
+    ASSERT_EQ(partition.ok.size() + partition.warnings.size() + partition.errors.size() + partition.invalid.size(), mixed.size());
+    ASSERT_EQ(partition.errors.size(), mixed.count_errors());
+    ASSERT_EQ(partition.warnings.size(), mixed.count_warnings());
+    for (std::size_t i : partition.ok) {
+        ASSERT_TRUE(mixed[i].is_no_error_or_warning());
+    }
+    for (std::size_t i : partition.warnings) {
+        ASSERT_TRUE(mixed[i].is_warning());
+    }
+    for (std::size_t i : partition.errors) {
+        ASSERT_TRUE(mixed[i].is_error());
+    }
+    for (std::size_t i : partition.invalid) {
+        ASSERT_FALSE(mixed[i].is_valid() or mixed[i].has_message());
+    }
+    ASSERT_TRUE(std::is_sorted(partition.invalid.begin(), partition.invalid.end()));
+}
+
+// Collect and traverse .
+TEST(StatusOptional, CollectAndTraverse) {
+    using SO = StatusOptional<int, std::string>;
+
+    std::vector<SO> values = {SO(1), SO::warning(2, "first"), SO(3), SO::warning(4, "second")};
+    StatusOptional<std::vector<int>, std::string> collected = collect(values.begin(), values.end());
+    ASSERT_TRUE(collected.is_warning());
+    ASSERT_EQ(collected.value(), std::vector<int>({1, 2, 3, 4}));
+    ASSERT_EQ(collected.message(), "first\nsecond");
+
+    std::vector<SO> failing = {SO(1), SO::error("bad 1"), SO(), SO::error("bad 3")};
+    auto failed = collect(failing.begin(), failing.end());
+    ASSERT_TRUE(failed.is_error());
+    ASSERT_EQ(failed.message(), "bad 1");
+
+    std::vector<SO> invalid = {SO(1), SO(), SO::error("bad 2")};
+    ASSERT_FALSE(collect(invalid.begin(), invalid.end()).is_valid());
+    ASSERT_FALSE(collect(invalid.begin(), invalid.end()).has_message());
+
+    std::vector<StatusOptional<std::string, int>> strings = {std::string(64, 'a'), std::string(64, 'b')};
+    char const* data = strings[0].value().data();
+    auto moved = collect(std::make_move_iterator(strings.begin()), std::make_move_iterator(strings.end()));
+    ASSERT_TRUE(moved.is_no_error_or_warning());
+    ASSERT_EQ(moved.value()[0].data(), data);
+
+    std::vector<int> inputs = {1, 2, 3, 4, 5};
+    int calls = 0;
+    auto halve = [&calls] (int i) {
+        calls++;
+        if (i % 2 == 0) {
+            return SO(i / 2);
+        }
+        return i == 3 ? SO::error("odd " + std::to_string(i)) : SO::warning(i, "rounded");
+    };
+    calls = 0;
+    auto traversed = traverse(inputs.begin(), inputs.end(), halve);
+    ASSERT_TRUE(traversed.is_error());
+    ASSERT_EQ(traversed.message(), "odd 3");
+    ASSERT_EQ(calls, 3);
+
+    auto check = [] (int i) { return i > 0 ? StatusOptional<void, std::string>() : StatusOptional<void, std::string>::error("negative"); };
+    ASSERT_TRUE(traverse(inputs.begin(), inputs.end(), check).is_no_error_or_warning());
+    inputs.push_back(-1);
+    ASSERT_TRUE(traverse(inputs.begin(), inputs.end(), check).is_error());
+}
+
+#if defined(__cpp_lib_execution)
+TEST(StatusOptional, ParallelCollectAndTraverse) {
+    using SO = StatusOptional<int, std::string>;
+
+    std::vector<int> inputs(100000);
+    for (std::size_t i = 0; i < inputs.size(); i++) {
+        inputs[i] = static_cast<int>(i);
+    }
+
+    auto withWarnings = [] (int i) { return i % 10000 == 5 ? SO::warning(i, std::to_string(i)) : SO(i); };
+    auto traversed = traverse(std::execution::par, inputs.begin(), inputs.end(), withWarnings);
+    ASSERT_TRUE(traversed.is_warning());
+    ASSERT_EQ(traversed.value().size(), inputs.size());
+    ASSERT_EQ(traversed.value()[54321], 54321);
+    ASSERT_EQ(traversed.message(), "5\n10005\n20005\n30005\n40005\n50005\n60005\n70005\n80005\n90005");
+
+    std::atomic<std::size_t> calls(0);
+    auto failing = [&calls] (int i) {
+        calls++;
+        return i % 1000 == 777 ? SO::error("error " + std::to_string(i)) : SO(i);
+    };
+    auto failed = traverse(std::execution::par, inputs.begin(), inputs.end(), failing);
+    ASSERT_TRUE(failed.is_error());
+    ASSERT_EQ(failed.message(), "error 777");
+    ASSERT_LT(calls.load(), inputs.size());
+
+    std::vector<SO> results(inputs.begin(), inputs.end());
+    auto collected = collect(std::execution::par_unseq, results.begin(), results.end());
+    ASSERT_TRUE(collected.is_no_error_or_warning());
+    ASSERT_EQ(collected.value(), inputs);
+}
+#endif
+
+// Error propagation .
+namespace {
+
+StatusOptional<int, std::string> parsePositive(std::string const& text) {
+    if (text.empty()) {
+        return StatusOptional<int, std::string>();
+    }
+    int ret = 0;
+    for (char c : text) {
+        if (c < '0' or c > '9') {
+            return StatusOptional<int, std::string>::error("not a number: " + text);
+        }
+        ret = 10 * ret + (c - '0');
+    }
+    if (ret == 0) {
+        return StatusOptional<int, std::string>::warning(ret, "zero");
+    }
+    return ret;
+}
+
+StatusOptional<void, std::string> checkEven(int i) {
+    if (i % 2 != 0) {
+        return StatusOptional<void, std::string>::error("odd: " + std::to_string(i));
+    }
+    return StatusOptional<void, std::string>();
+}
+
+StatusOptional<long, std::string> tryProduct(std::string const& a, std::string const& b) {
+    STATUS_OPTIONAL_TRY_ASSIGN(int left, parsePositive(a));
+    STATUS_OPTIONAL_TRY_ASSIGN(int right, parsePositive(b));
+    STATUS_OPTIONAL_TRY(checkEven(left));
+    return static_cast<long>(left) * right;
+}
+
+StatusOptional<void, std::string> tryValidate(std::string const& a) {
+    StatusOptional<int, std::string> parsed = parsePositive(a);
+    STATUS_OPTIONAL_TRY(parsed);
+    STATUS_OPTIONAL_TRY(checkEven(parsed.value()));
+    return StatusOptional<void, std::string>();
+}
+
+}
+
+TEST(StatusOptional, TryMacro) {
+    ASSERT_EQ(tryProduct("6", "7").value(), 42);
+    ASSERT_TRUE(tryProduct("0", "7").is_no_error_or_warning());
+
+    auto notNumber = tryProduct("6", "x");
+    ASSERT_TRUE(notNumber.is_error());
+    ASSERT_EQ(notNumber.message(), "not a number: x");
+
+    auto odd = tryProduct("3", "7");
+    ASSERT_TRUE(odd.is_error());
+    ASSERT_EQ(odd.message(), "odd: 3");
+
+    ASSERT_FALSE(tryProduct("", "7").is_valid());
+
+    ASSERT_TRUE(tryValidate("4").is_no_error_or_warning());
+    ASSERT_EQ(tryValidate("5").message(), "odd: 5");
+    ASSERT_EQ(tryValidate("y").message(), "not a number: y");
+    ASSERT_FALSE(tryValidate("").is_valid());
+}
+
+#if defined(__cpp_impl_coroutine)
+namespace {
+
+StatusOptional<long, std::string> coProduct(std::string const& a, std::string const& b) {
+    int left = co_await parsePositive(a);
+    StatusOptional<int, std::string> right = parsePositive(b);
+    int const& rightValue = co_await right;
+    co_await checkEven(left);
+    co_return static_cast<long>(left) * rightValue;
+}
+
+StatusOptional<void, std::string> coValidate(std::string const& a) {
+    int parsed = co_await parsePositive(a);
+    co_return checkEven(parsed);
+}
+
+// trivially copyable, so returned in registers.
+StatusOptional<int, int> coHalf(int val) {
+    if (val % 2 != 0) {
+        co_await StatusOptional<int, int>::error(val);
+    }
+    co_return val / 2;
+}
+
+// the warning of the awaited result is dropped.
+StatusOptional<int, std::string> coIgnoreWarning(int val) {
+    int awaited = co_await StatusOptional<int, std::string>::warning(val, "dropped");
+    co_return awaited + 1;
+}
+
+// a void coroutine ends with an explicit co_return, the promise having no return_void.
+StatusOptional<void, std::string> coCheckPositive(std::string const& a) {
+    co_await parsePositive(a);
+    co_return StatusOptional<void, std::string>();
+}
+
+StatusOptional<int, int> coThrow() {
+    co_await StatusOptional<int, int>(1);
+    throw std::runtime_error("thrown in a coroutine");
+}
+
+}
+
+TEST(StatusOptional, Coroutines) {
+    ASSERT_EQ(coProduct("6", "7").value(), 42);
+
+    auto notNumber = coProduct("6", "x");
+    ASSERT_TRUE(notNumber.is_error());
+    ASSERT_EQ(notNumber.message(), "not a number: x");
+
+    ASSERT_EQ(coProduct("3", "7").message(), "odd: 3");
+    ASSERT_FALSE(coProduct("", "7").is_valid());
+
+    ASSERT_TRUE(coValidate("4").is_no_error_or_warning());
+    ASSERT_EQ(coValidate("5").message(), "odd: 5");
+    ASSERT_FALSE(coValidate("").is_valid());
+
+    ASSERT_EQ(coHalf(8).value(), 4);
+    ASSERT_EQ(coHalf(7).message(), 7);
+    ASSERT_THROW(coThrow(), std::runtime_error);
+
+    auto resumed = coIgnoreWarning(2);
+    ASSERT_TRUE(resumed.is_no_error_or_warning());
+    ASSERT_EQ(resumed.value(), 3);
+
+    ASSERT_TRUE(coCheckPositive("4").is_no_error_or_warning());
+    ASSERT_EQ(coCheckPositive("x").message(), "not a number: x");
+}
+
+TEST(StatusOptional, CoroutineEagerConversion) {
+    using SO = StatusOptional<int, int>;
+    using Promise = std::coroutine_traits<SO>::promise_type;
+
+    // a compiler converting the return object before the body runs gets an abort, not a dangling result.
+    ASSERT_DEATH({
+        Promise promise;
+        auto returned = promise.get_return_object();
+        SO converted = returned;
+        promise.return_value(3);
+        (void) converted;
+    }, "converted to its result before completing");
+
+    // converted once completed, the result is moved out of the return object.
+    Promise promise;
+    auto returned = promise.get_return_object();
+    promise.return_value(3);
+    SO converted = returned;
+    ASSERT_EQ(converted.value(), 3);
+}
+#endif
+
+// Out of line errors .
+TEST(StatusOptional, OutOfLineErrors) {
+
+    int formatted = 0;
+    auto format = [&formatted] (int index) {
+        return [&formatted, index] () {
+            formatted++;
+            return "invalid record " + std::to_string(index);
+        };
+    };
+
+    auto error = StatusOptional<int, std::string>::error_from(format(3));
+    ASSERT_TRUE(error.is_error());
+    ASSERT_EQ(error.message(), "invalid record 3");
+
+    auto warning = StatusOptional<int, std::string>::warning_from(7, format(4));
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.value(), 7);
+    ASSERT_EQ(warning.message(), "invalid record 4");
+
+    auto voidError = StatusOptional<void, std::string>::error_from(format(5));
+    ASSERT_TRUE(voidError.is_error());
+    ASSERT_EQ(voidError.message(), "invalid record 5");
+
+    auto voidWarning = StatusOptional<void, std::string>::warning_from(format(6));
+    ASSERT_TRUE(voidWarning.is_warning());
+    ASSERT_EQ(voidWarning.message(), "invalid record 6");
+
+    ASSERT_EQ(formatted, 4);
+
+    auto moveOnly = StatusOptional<std::unique_ptr<int>, std::string>::warning_from(std::make_unique<int>(8), format(7));
+    ASSERT_EQ(*moveOnly.value(), 8);
+
+    ASSERT_THROW(error.value(), std::bad_optional_access);
+    StatusOptional<int, std::string> value(1);
+    ASSERT_THROW(value.message(), std::bad_optional_access);
+    StatusOptional<void, std::string> ok;
+    ASSERT_THROW(ok.message(), std::bad_optional_access);
+}
+
+// Warning sink .
+TEST(StatusOptional, WarningSink) {
+
+    WarningSink<std::string> sink(3);
+    ASSERT_EQ(sink.capacity(), 4u);
+
+    auto warning = StatusOptional<int, std::string>::warning(1, "first");
+    auto error = StatusOptional<int, std::string>::error("error");
+    StatusOptional<int, std::string> value(2);
+    auto voidWarning = StatusOptional<void, std::string>::warning("second");
+
+    ASSERT_TRUE(sink.take_message(warning));
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.value(), 1);
+    ASSERT_FALSE(sink.take_message(error));
+    ASSERT_EQ(error.message(), "error");
+    ASSERT_FALSE(sink.take_message(value));
+    ASSERT_TRUE(sink.take_message(voidWarning));
+
+    std::vector<std::string> drained = sink.drain();
+    ASSERT_EQ(drained, (std::vector<std::string>{"first", "second"}));
+    ASSERT_TRUE(sink.drain().empty());
+
+    for (int i = 0; i < 6; i++) {
+        std::string msg = std::to_string(i);
+        bool queued = sink.push(std::move(msg));
+        ASSERT_EQ(queued, i < 4);
+        if (!queued) {
+            ASSERT_EQ(msg, std::to_string(i));
+        }
+    }
+    ASSERT_EQ(sink.dropped(), 2u);
+
+    std::vector<std::string> seen;
+    ASSERT_EQ(sink.drain([&seen] (std::string && msg) { seen.push_back(std::move(msg)); }), 4u);
+    ASSERT_EQ(seen, (std::vector<std::string>{"0", "1", "2", "3"}));
+
+    {
+        auto producer = sink.producer(2);
+        auto batched = StatusOptional<int, std::string>::warning(3, "batched");
+        ASSERT_TRUE(producer.take_message(batched));
+        ASSERT_TRUE(sink.drain().empty());
+        producer.push("second batched");
+        ASSERT_EQ(sink.drain().size(), 2u);
+        producer.push("flushed on destruction");
+    }
+    ASSERT_EQ(sink.drain(), (std::vector<std::string>{"flushed on destruction"}));
+
+    WarningSink<std::string> unread(8);
+    unread.push("destroyed with the sink");
+}
+
+TEST(StatusOptional, WarningSinkConcurrentProducers) {
+
+    constexpr int ThreadCount = 4;
+    constexpr int MessageCount = 20000;
+
+    WarningSink<std::string> sink(256);
+    std::atomic<int> running(ThreadCount);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadCount; t++) {
+        threads.emplace_back([&sink, &running, t] () {
+            auto producer = sink.producer(t % 2 == 0 ? 1 : 16);
+            for (int i = 0; i < MessageCount; i++) {
+                auto result = StatusOptional<int, std::string>::warning(i, std::to_string(t) + ' ' + std::to_string(i));
+                producer.take_message(result);
+            }
+            producer.flush();
+            running--;
+        });
+    }
+
+    std::vector<int> next(ThreadCount, 0);
+    std::size_t received = 0;
+    bool ordered = true;
+    auto consume = [&] (std::string && msg) {
+        std::size_t space = msg.find(' ');
+        int t = std::stoi(msg.substr(0, space));
+        int i = std::stoi(msg.substr(space + 1));
+        ordered = ordered and i >= next[t];
+        next[t] = i + 1;
+        received++;
+    };
+    while (running.load() > 0) {
+        sink.drain(consume);
+    }
+    sink.drain(consume);
+
+    for (std::thread & thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(received + sink.dropped(), std::size_t(ThreadCount) * MessageCount);
+}
+
+// Warning lists .
+TEST(StatusOptional, WarningList) {
+
+    using Warnings = WarningList<std::string, 2>;
+    using SO = StatusOptional<int, Warnings>;
+
+    SO first = SO::warning(1, "first");
+    ASSERT_EQ(first.message().size(), 1u);
+    ASSERT_EQ(first.message()[0], "first");
+
+    SO chained = first.and_then([] (int val) { return SO::warning(val + 1, "second"); })
+                      .and_then([] (int val) { return SO(val + 1); })
+                      .and_then([] (int val) { return SO::warning(val + 1, "third"); });
+    ASSERT_TRUE(chained.is_warning());
+    ASSERT_EQ(chained.value(), 4);
+
+    std::vector<std::string> messages(chained.message().begin(), chained.message().end());
+    ASSERT_EQ(messages, (std::vector<std::string>{"first", "second", "third"}));
+    ASSERT_FALSE(chained.message().is_inline());
+
+    auto failed = first.and_then([] (int) { return SO::error("failed"); });
+    ASSERT_TRUE(failed.is_error());
+    ASSERT_EQ(failed.message().size(), 1u);
+    ASSERT_EQ(failed.message()[0], "failed");
+
+    SO value(5);
+    ASSERT_TRUE(merge_warnings(value, SO::warning(0, "merged")));
+    ASSERT_TRUE(value.is_warning());
+    ASSERT_EQ(value.value(), 5);
+    ASSERT_EQ(value.message().front(), "merged");
+
+    ASSERT_TRUE(merge_warnings(value, StatusOptional<void, Warnings>::warning("from void")));
+    ASSERT_EQ(value.message().size(), 2u);
+    ASSERT_EQ(value.message().back(), "from void");
+    ASSERT_TRUE(value.message().is_inline());
+
+    ASSERT_FALSE(merge_warnings(value, SO(6)));
+    ASSERT_FALSE(merge_warnings(value, SO::error("error")));
+    ASSERT_EQ(value.message().size(), 2u);
+
+    SO error = SO::error("error");
+    ASSERT_TRUE(merge_warnings(error, SO::warning(0, "ignored")));
+    ASSERT_EQ(error.message().size(), 1u);
+
+    std::vector<SO> results;
+    results.push_back(SO::warning(1, "a"));
+    results.push_back(SO(2));
+    results.push_back(SO::warning(3, "b"));
+    results.push_back(SO::warning(4, "c"));
+    auto collected = collect(std::make_move_iterator(results.begin()), std::make_move_iterator(results.end()));
+    ASSERT_EQ(collected.value(), (std::vector<int>{1, 2, 3, 4}));
+    std::vector<std::string> collectedMessages(collected.message().begin(), collected.message().end());
+    ASSERT_EQ(collectedMessages, (std::vector<std::string>{"a", "b", "c"}));
+}
+
+TEST(StatusOptional, WarningListStorage) {
+
+    using Warnings = WarningList<std::string, 2>;
+
+    Warnings list;
+    list.push_back("a long enough message to live on the heap");
+    list.push_back("b");
+    ASSERT_TRUE(list.is_inline());
+    list.push_back("c");
+    ASSERT_FALSE(list.is_inline());
+    ASSERT_EQ(list.size(), 3u);
+
+    std::string const* heapData = &list[0];
+    Warnings moved(std::move(list));
+    ASSERT_EQ(&moved[0], heapData);
+    ASSERT_TRUE(list.empty());
+
+    Warnings appended;
+    appended.append(std::move(moved));
+    ASSERT_EQ(&appended[0], heapData);
+    ASSERT_EQ(appended.size(), 3u);
+    ASSERT_TRUE(moved.empty());
+
+    Warnings small("x");
+    Warnings copy(small);
+    copy.append(small);
+    ASSERT_EQ(copy.size(), 2u);
+    ASSERT_TRUE(copy.is_inline());
+    Warnings movedSmall(std::move(copy));
+    ASSERT_EQ(movedSmall.size(), 2u);
+    ASSERT_EQ(movedSmall[1], "x");
+
+    copy = appended;
+    ASSERT_EQ(copy, appended);
+    appended = std::move(movedSmall);
+    ASSERT_EQ(appended.size(), 2u);
+
+    // appending a list to itself, within the inline storage and past it
+    Warnings self("a long enough message to live on the heap");
+    self.append(self);
+    ASSERT_TRUE(self.is_inline());
+    self.append(self);
+    ASSERT_FALSE(self.is_inline());
+    ASSERT_EQ(self.size(), 4u);
+    self.append(std::move(self));
+    ASSERT_EQ(self.size(), 8u);
+    for (std::string const& msg : self) {
+        ASSERT_EQ(msg, "a long enough message to live on the heap");
+    }
+
+    Warnings grown("first message, long enough to live on the heap");
+    grown.push_back("b");
+    grown.push_back(grown[0]);
+    ASSERT_FALSE(grown.is_inline());
+    ASSERT_EQ(grown.back(), grown.front());
+}
+
+// State and visit .
+TEST(StatusOptional, StateAndVisit) {
+
+    using SO = StatusOptional<std::unique_ptr<int>, std::string>;
+
+    static_assert(StatusOptional<int, char>().state() == StatusOptionalState::Invalid);
+    static_assert(StatusOptional<int, char>(1).state() == StatusOptionalState::Ok);
+    static_assert(StatusOptional<int, char>::warning(1, 'w').state() == StatusOptionalState::Warning);
+    static_assert(StatusOptional<int, char>::error('e').state() == StatusOptionalState::Error);
+    static_assert(StatusOptional<void, char>().state() == StatusOptionalState::Ok);
+    static_assert(StatusOptional<void, char>::warning('w').state() == StatusOptionalState::Warning);
+    static_assert(StatusOptional<void, char>::error('e').state() == StatusOptionalState::Error);
+
+    auto describe = [] (auto const& result) {
+        return result.visit([] (auto const& val) { return "ok " + std::to_string(*val); },
+                            [] (auto const& val, std::string const& msg) { return "warning " + std::to_string(*val) + ' ' + msg; },
+                            [] (std::string const& msg) { return "error " + msg; },
+                            [] () { return std::string("invalid"); });
+    };
+
+    ASSERT_EQ(describe(SO(std::make_unique<int>(1))), "ok 1");
+    ASSERT_EQ(describe(SO::warning(std::make_unique<int>(2), "w")), "warning 2 w");
+    ASSERT_EQ(describe(SO::error("e")), "error e");
+    ASSERT_EQ(describe(SO()), "invalid");
+
+    std::unique_ptr<int> taken = SO::warning(std::make_unique<int>(3), "w").visit(
+                [] (std::unique_ptr<int> && val) { return std::move(val); },
+                [] (std::unique_ptr<int> && val, std::string && msg) { (void) msg; return std::move(val); },
+                [] (std::string &&) { return std::unique_ptr<int>(); },
+                [] () { return std::unique_ptr<int>(); });
+    ASSERT_EQ(*taken, 3);
+
+    SO mutated(std::make_unique<int>(4));
+    mutated.visit([] (std::unique_ptr<int> & val) { *val = 5; },
+                  [] (std::unique_ptr<int> &, std::string &) {},
+                  [] (std::string &) {},
+                  [] () {});
+    ASSERT_EQ(*mutated.value(), 5);
+
+    auto describeVoid = [] (StatusOptional<void, std::string> const& result) {
+        return result.visit([] () { return 0; },
+                            [] (std::string const& msg) { return int(msg.size()); },
+                            [] (std::string const& msg) { return -int(msg.size()); },
+                            [] () { return -100; });
+    };
+
+    ASSERT_EQ(describeVoid(StatusOptional<void, std::string>()), 0);
+    ASSERT_EQ(describeVoid(StatusOptional<void, std::string>::warning("ab")), 2);
+    ASSERT_EQ(describeVoid(StatusOptional<void, std::string>::error("abc")), -3);
+
+    switch (SO::error("e").state()) {
+    case StatusOptionalState::Error:
+        break;
+    default:
+        FAIL();
+    }
+}
+
+// Unchecked accessors .
+TEST(StatusOptional, UncheckedAccessors) {
+
+    StatusOptional<Foo, std::string> warning = StatusOptional<Foo, std::string>::warning(Foo{1, "fizz"}, "warning");
+    ASSERT_EQ((*warning).fizz, 1);
+    ASSERT_EQ(warning->buzz, "fizz");
+    ASSERT_EQ(&warning.unchecked_value(), &warning.value());
+    ASSERT_EQ(&warning.unchecked_message(), &warning.message());
+
+    (*warning).fizz = 2;
+    warning.unchecked_message() = "changed";
+    StatusOptional<Foo, std::string> const& constWarning = warning;
+    ASSERT_EQ(constWarning.unchecked_value().fizz, 2);
+    ASSERT_EQ(constWarning->fizz, 2);
+    ASSERT_EQ(constWarning.unchecked_message(), "changed");
+
+    auto error = StatusOptional<void, std::string>::error("error");
+    ASSERT_EQ(error.unchecked_message(), "error");
+
+    constexpr StatusOptional<int, char> constant(3);
+    static_assert(*constant == 3);
+    static_assert(constant.unchecked_value() == 3);
+}
+
+// Converting constructors .
+TEST(StatusOptional, ConvertingConstructors) {
+
+    static_assert(std::is_convertible_v<StatusOptional<short, std::string>, StatusOptional<int, std::string>>);
+    static_assert(std::is_convertible_v<StatusOptional<int, char const*>, StatusOptional<int, std::string>>);
+    static_assert(!std::is_convertible_v<StatusOptional<int, std::string>, StatusOptional<void, std::string>>);
+    static_assert(std::is_constructible_v<StatusOptional<void, std::string>, StatusOptional<int, std::string>>);
+    static_assert(!std::is_constructible_v<StatusOptional<std::string, std::string>, StatusOptional<void, std::string>>);
+    static_assert(!std::is_constructible_v<StatusOptional<std::string, char const*>, StatusOptional<std::string, std::string>>);
+
+    StatusOptional<int, std::string> value = StatusOptional<short, std::string>(3);
+    ASSERT_TRUE(value.is_no_error_or_warning());
+    ASSERT_EQ(value.value(), 3);
+
+    StatusOptional<int, std::string> warning = StatusOptional<int, char const*>::warning(4, "warning");
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.value(), 4);
+    ASSERT_EQ(warning.message(), "warning");
+
+    StatusOptional<long, std::string> copied(warning);
+    ASSERT_TRUE(copied.is_warning());
+    ASSERT_EQ(copied.value(), 4);
+    ASSERT_EQ(warning.message(), "warning");
+
+    StatusOptional<void, std::string> dropped(warning);
+    ASSERT_TRUE(dropped.is_warning());
+    StatusOptional<void, std::string> voidError = StatusOptional<void, char const*>::error("error");
+    ASSERT_TRUE(voidError.is_error());
+    ASSERT_EQ(voidError.message(), "error");
+    StatusOptional<void, std::string> invalid(StatusOptional<int, std::string>{});
+    ASSERT_FALSE(invalid.is_valid());
+
+    StatusOptional<std::unique_ptr<Foo const>, std::string> moveOnly = StatusOptional<std::unique_ptr<Foo>, std::string>(std::make_unique<Foo>(Foo{5, "fizz"}));
+    ASSERT_EQ(moveOnly.value()->fizz, 5);
+
+    using SO = StatusOptional<std::unique_ptr<int>, ConstructionCounter>;
+    SO error = SO::error_in_place(1, "error");
+    ConstructionCounter::constructions = 0;
+    StatusOptional<double, ConstructionCounter> propagated = std::move(error).propagate_error<double>();
+    ASSERT_EQ(ConstructionCounter::constructions, 1);
+    ASSERT_TRUE(propagated.is_error());
+    ASSERT_EQ(propagated.message().buzz, "error");
+
+    ConstructionCounter::constructions = 0;
+    StatusOptional<void, ConstructionCounter> voidPropagated = std::move(propagated).propagate_error<void>();
+    ASSERT_EQ(ConstructionCounter::constructions, 1);
+    ASSERT_EQ(voidPropagated.message().fizz, 1);
+
+    StatusOptional<int, std::string> invalidInt;
+    ASSERT_FALSE(std::move(invalidInt).propagate_error<double>().is_valid());
+
+    // a warning is not turned into an error
+    auto warningInt = StatusOptional<int, std::string>::warning(1, "warning");
+    ASSERT_THROW(std::move(warningInt).propagate_error<double>(), std::bad_optional_access);
+    ASSERT_EQ(warningInt.message(), "warning");
+    StatusOptional<int, std::string> valueInt(1);
+    ASSERT_THROW(std::move(valueInt).propagate_error<double>(), std::bad_optional_access);
+    using VoidSO = StatusOptional<void, std::string>;
+    auto voidWarning = VoidSO::warning("warning");
+    ASSERT_THROW(std::move(voidWarning).propagate_error<int>(), std::bad_optional_access);
+    ASSERT_THROW(VoidSO().propagate_error<int>(), std::bad_optional_access);
+}
+
+// Reference specialization .
+TEST(StatusOptional, References) {
+
+    std::vector<Foo> cache = {Foo{1, "fizz"}, Foo{2, "buzz"}};
+    auto lookup = [&cache] (int fizz) {
+        for (Foo & entry : cache) {
+            if (entry.fizz == fizz) {
+                return StatusOptional<Foo&, std::string>(entry);
+            }
+        }
+        return StatusOptional<Foo&, std::string>::error("not found");
+    };
+
+    StatusOptional<Foo&, std::string> hit = lookup(2);
+    ASSERT_TRUE(hit.is_no_error_or_warning());
+    ASSERT_EQ(&hit.value(), &cache[1]);
+    hit->buzz = "changed";
+    ASSERT_EQ(cache[1].buzz, "changed");
+
+    StatusOptional<Foo&, std::string> miss = lookup(3);
+    ASSERT_TRUE(miss.is_error());
+    ASSERT_EQ(miss.message(), "not found");
+    ASSERT_THROW(miss.value(), std::bad_optional_access);
+    Foo fallback{0, "fallback"};
+    ASSERT_EQ(miss.value_or(fallback).buzz, "fallback");
+    ASSERT_EQ(hit.value_or(fallback).buzz, "changed");
+
+    auto warning = StatusOptional<Foo&, std::string>::warning(cache[0], "stale");
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(&*warning, &cache[0]);
+
+    StatusOptional<Foo const&, std::string> constHit = hit;
+    ASSERT_EQ(&constHit.value(), &cache[1]);
+    static_assert(!std::is_constructible_v<StatusOptional<Foo const&, std::string>, Foo>);
+    static_assert(!std::is_constructible_v<StatusOptional<Foo&, std::string>, Foo const&>);
+
+    StatusOptional<int, std::string> fizz = warning.transform([] (Foo const& entry) { return entry.fizz; });
+    ASSERT_TRUE(fizz.is_warning());
+    ASSERT_EQ(fizz.value(), 1);
+    ASSERT_EQ(hit.and_then([&] (Foo & entry) { return lookup(entry.fizz - 1); }).operator->(), &cache[0]);
+    ASSERT_EQ(&warning.transform_error([] (std::string const& msg) { return msg.size(); }).value(), &cache[0]);
+    ASSERT_EQ(&miss.or_else([&] (std::string const&) { return lookup(1); }).value(), &cache[0]);
+    StatusOptional<void, std::string> status(miss);
+    ASSERT_TRUE(status.is_error());
+    ASSERT_EQ(std::move(miss).propagate_error<int>().message(), "not found");
+}
+
+// Serialization .
+namespace {
+
+enum class Color : std::uint8_t {
+    Red,
+    Green
+};
+
+struct Point {
+    std::int32_t x;
+    std::int32_t y;
+};
+
+}
+
+template <>
+struct status_optional_codec<Point> : status_optional_trivial_codec<Point> {};
+
+TEST(StatusOptional, Serialization) {
+
+    std::vector<unsigned char> buffer;
+    status_optional_encode(StatusOptional<int, std::string>(42), buffer);
+    status_optional_encode(StatusOptional<int, std::string>::warning(7, "warning"), buffer);
+    status_optional_encode(StatusOptional<int, std::string>::error("error"), buffer);
+    status_optional_encode(StatusOptional<int, std::string>(), buffer);
+    ASSERT_EQ(buffer.size(), (1 + sizeof(int)) + (1 + sizeof(int) + 1 + 7) + (1 + 1 + 5) + 1);
+
+    std::size_t offset = 0;
+    StatusOptionalView<int, std::string> ok(buffer.data(), buffer.size());
+    ASSERT_TRUE(ok.well_formed());
+    ASSERT_TRUE(ok.is_no_error_or_warning());
+    ASSERT_EQ(ok.value(), 42);
+    ASSERT_THROW(ok.message(), std::bad_optional_access);
+    offset += ok.encoded_size();
+
+    StatusOptionalView<int, std::string> warning(buffer.data() + offset, buffer.size() - offset);
+    ASSERT_TRUE(warning.is_warning());
+    ASSERT_EQ(warning.message_bytes_size(), 7u);
+    ASSERT_EQ(std::string(reinterpret_cast<char const*>(warning.message_bytes()), warning.message_bytes_size()), "warning");
+    StatusOptional<int, std::string> decoded = warning;
+    ASSERT_TRUE(decoded.is_warning());
+    ASSERT_EQ(decoded.value(), 7);
+    ASSERT_EQ(decoded.message(), "warning");
+    offset += warning.encoded_size();
+
+    StatusOptional<int, std::string> error = status_optional_decode<int>(buffer.data() + offset, buffer.size() - offset);
+    ASSERT_TRUE(error.is_error());
+    ASSERT_EQ(error.message(), "error");
+    offset += status_optional_encoded_size(error);
+
+    StatusOptionalView<int, std::string> invalid(buffer.data() + offset, buffer.size() - offset);
+    ASSERT_TRUE(invalid.well_formed());
+    ASSERT_FALSE(invalid.is_valid());
+    ASSERT_EQ(offset + invalid.encoded_size(), buffer.size());
+
+    // a truncated buffer, or an unknown state, is not well formed.
+    StatusOptionalView<int, std::string> truncated(buffer.data() + ok.encoded_size(), warning.encoded_size() - 1);
+    ASSERT_FALSE(truncated.well_formed());
+    ASSERT_FALSE(truncated.is_valid());
+    unsigned char unknown = 4;
+    ASSERT_FALSE((StatusOptionalView<int, std::string>(&unknown, 1).well_formed()));
+
+    std::vector<unsigned char> others;
+    status_optional_encode(StatusOptional<std::string, Color>::warning("value", Color::Green), others);
+    status_optional_encode(StatusOptional<void, std::string>::warning("void warning"), others);
+    status_optional_encode(StatusOptional<Point, std::string>(Point{3, 4}), others);
+    StatusOptionalView<std::string, Color> stringValue(others.data(), others.size());
+    ASSERT_EQ(stringValue.value(), "value");
+    ASSERT_EQ(stringValue.message(), Color::Green);
+    offset = stringValue.encoded_size();
+    StatusOptionalView<void, std::string> voidWarning(others.data() + offset, others.size() - offset);
+    ASSERT_TRUE(voidWarning.is_warning());
+    ASSERT_EQ(voidWarning.message(), "void warning");
+    offset += voidWarning.encoded_size();
+    ASSERT_EQ(status_optional_decode<Point>(others.data() + offset, others.size() - offset).value().y, 4);
+
+    // a length which is not a whole number of characters is malformed, and not decoded.
+    unsigned char const oddLength[] = {static_cast<unsigned char>(StatusOptionalState::Ok), 3, 'a', 0, 'b'};
+    StatusOptionalView<std::u16string, std::string> odd(oddLength, sizeof(oddLength));
+    ASSERT_FALSE(odd.well_formed());
+    ASSERT_FALSE((status_optional_decode<std::u16string, std::string>(oddLength, sizeof(oddLength)).is_valid()));
+    ASSERT_EQ(status_optional_codec<std::u16string>::decode(oddLength + 2, 3), std::u16string(1, u'a'));
+}
+
+TEST(StatusOptional, BatchSerialization) {
+
+    StatusOptionalBatch<int, std::string> batch;
+    for (int i = 0; i < 150; i++) {
+        if (i % 10 == 3) {
+            batch.push_error("error " + std::to_string(i));
+        } else if (i % 10 == 7) {
+            batch.push_warning(i, "warning " + std::to_string(i));
+        } else if (i == 149) {
+            batch.push_invalid();
+        } else {
+            batch.push_value(i);
+        }
+    }
+
+    std::vector<unsigned char> buffer;
+    status_optional_encode(batch, buffer);
+
+    StatusOptionalBatch<int, std::string> decoded;
+    ASSERT_TRUE(status_optional_decode_batch(buffer.data(), buffer.size(), decoded));
+    ASSERT_EQ(decoded.size(), batch.size());
+    ASSERT_EQ(decoded.count_errors(), batch.count_errors());
+    ASSERT_EQ(decoded.count_warnings(), batch.count_warnings());
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        ASSERT_EQ(decoded[i].is_valid(), batch[i].is_valid());
+        ASSERT_EQ(decoded[i].has_value(), batch[i].has_value());
+        if (batch[i].has_value()) {
+            ASSERT_EQ(decoded[i].value(), batch[i].value());
+        }
+        if (batch[i].has_message()) {
+            ASSERT_EQ(decoded[i].message(), batch[i].message());
+        }
+    }
+
+    StatusOptionalBatch<int, std::string> untouched;
+    ASSERT_FALSE(status_optional_decode_batch(buffer.data(), buffer.size() - 1, untouched));
+    ASSERT_TRUE(untouched.empty());
+
+    StatusOptionalBatch<std::string, std::string> strings;
+    strings.push_value("a");
+    strings.push_error("b");
+    buffer.clear();
+    status_optional_encode(strings, buffer);
+    StatusOptionalBatch<std::string, std::string> decodedStrings;
+    ASSERT_TRUE(status_optional_decode_batch(buffer.data(), buffer.size(), decodedStrings));
+    ASSERT_EQ(decodedStrings[0].value(), "a");
+    ASSERT_EQ(decodedStrings[1].message(), "b");
+
+    StatusOptionalBatch<int, std::u16string> wide;
+    wide.push_error(u"ab");
+    buffer.clear();
+    status_optional_encode(wide, buffer);
+    ASSERT_EQ(buffer[buffer.size() - 5], 4);
+    buffer[buffer.size() - 5] = 3;
+    StatusOptionalBatch<int, std::u16string> decodedWide;
+    ASSERT_FALSE(status_optional_decode_batch(buffer.data(), buffer.size(), decodedWide));
+    ASSERT_TRUE(decodedWide.empty());
+}
+
+// Core header .
+static_assert(std::is_same_v<StatusOptional<int>, StatusOptional<int, std::string>>, "status_optional.h should make std::string the default message type");
+static_assert(status_optional_detail::is_string_like<std::string>::value, "std::string messages should be merged as strings");
+static_assert(status_optional_detail::is_string_like<std::wstring>::value, "std::wstring messages should be merged as strings");
+static_assert(!status_optional_detail::is_string_like<StaticMessage>::value, "StaticMessage should not be merged as a string");
+static_assert(!status_optional_detail::is_string_like<WarningList<>>::value, "WarningList should not be merged as a string");
+
+// Storage reuse .
+static_assert(sizeof(StatusOptional<int, ReusableMessage<>>) == sizeof(StatusOptional<int, std::string>), "Unexpected StatusOptional size");
+
+TEST(StatusOptional, InPlaceMutators) {
+    using SO = StatusOptional<int, std::string>;
+
+    SO result = 3;
+    std::string& msg = result.emplace_message(4, 'x');
+    ASSERT_TRUE(result.is_warning());
+    ASSERT_EQ(msg, "xxxx");
+    ASSERT_EQ(result.value(), 3);
+
+    result.set_error("failed");
+    ASSERT_TRUE(result.is_error());
+    ASSERT_EQ(result.message(), "failed");
+
+    result.set_warning(5, "partial");
+    ASSERT_TRUE(result.is_warning());
+    ASSERT_EQ(result.value(), 5);
+    ASSERT_EQ(result.message(), "partial");
+
+    result.reset();
+    ASSERT_FALSE(result.is_valid());
+    ASSERT_FALSE(result.has_message());
+
+    result.emplace_message("no value");
+    ASSERT_TRUE(result.is_error());
+
+    StatusOptional<void, std::string> status;
+    status.set_warning("careful");
+    ASSERT_TRUE(status.is_warning());
+    status.set_error("failed");
+    ASSERT_TRUE(status.is_error());
+    ASSERT_EQ(status.message(), "failed");
+    status.reset();
+    ASSERT_TRUE(status.is_no_error_or_warning());
+    status.emplace_message("careful");
+    ASSERT_TRUE(status.is_warning());
+}
+
+TEST(StatusOptional, ReusableMessages) {
+    using SO = StatusOptional<int, ReusableMessage<>>;
+    static_assert(std::is_same_v<std::decay_t<decltype(std::declval<SO&>().message())>, std::string>, "Unexpected function return type");
+
+    SO result = SO::warning(1, std::string(100, 'w'));
+    char const* buffer = result.message().data();
+    std::size_t capacity = result.message().capacity();
+
+    // the dropped message is cleared, the next one is assigned to it.
+    for (int i = 0; i < 8; i++) {
+        result = i;
+        ASSERT_TRUE(result.is_no_error_or_warning());
+        ASSERT_FALSE(result.has_message());
+
+        result.set_warning(i, "line " + std::to_string(i));
+        ASSERT_TRUE(result.is_warning());
+        ASSERT_EQ(result.message(), "line " + std::to_string(i));
+        ASSERT_EQ(result.message().data(), buffer);
+
+        result.reset();
+        ASSERT_FALSE(result.is_valid());
+
+        result.emplace_message("error");
+        ASSERT_TRUE(result.is_error());
+        ASSERT_EQ(result.message().data(), buffer);
+        ASSERT_EQ(result.message().capacity(), capacity);
+
+        result.emplace_value(i);
+    }
+
+    // copies and moves only carry the messages which are there.
+    SO copy = result;
+    ASSERT_TRUE(copy.is_no_error_or_warning());
+    SO moved = std::move(result);
+    ASSERT_TRUE(moved.is_no_error_or_warning());
+    moved.set_error("failed");
+    copy = moved;
+    ASSERT_TRUE(copy.is_error());
+    ASSERT_EQ(copy.message(), "failed");
+
+    StatusOptional<void, ReusableMessage<>> status = StatusOptional<void, ReusableMessage<>>::error(std::string(100, 'e'));
+    buffer = status.message().data();
+    status.reset();
+    ASSERT_TRUE(status.is_no_error_or_warning());
+    status.set_warning("careful");
+    ASSERT_TRUE(status.is_warning());
+    ASSERT_EQ(status.message().data(), buffer);
+}
+
+// std::expected interoperability .
+#if defined(__cpp_lib_expected)
+TEST(StatusOptional, Expected) {
+    using SO = StatusOptional<ConstructionCounter, ConstructionCounter>;
+    using Exp = std::expected<ConstructionCounter, ConstructionCounter>;
+
+    ConstructionCounter::constructions = 0;
+    Exp value = to_expected(SO(std::in_place, 1, "value"), ExpectedWarning::DropMessage);
+    ASSERT_EQ(ConstructionCounter::constructions, 2);
+    ASSERT_EQ(value->buzz, "value");
+
+    ConstructionCounter::constructions = 0;
+    SO back = to_status_optional(std::move(value));
+    ASSERT_EQ(ConstructionCounter::constructions, 1);
+    ASSERT_TRUE(back.is_no_error_or_warning());
+    ASSERT_EQ(back.value().fizz, 1);
+
+    ConstructionCounter::constructions = 0;
+    Exp error = to_expected(SO::error_in_place(2, "error"), ExpectedWarning::DropMessage);
+    ASSERT_EQ(ConstructionCounter::constructions, 2);
+    ASSERT_EQ(error.error().buzz, "error");
+
+    ConstructionCounter::constructions = 0;
+    SO backError = to_status_optional(std::move(error));
+    ASSERT_EQ(ConstructionCounter::constructions, 1);
+    ASSERT_TRUE(backError.is_error());
+    ASSERT_EQ(backError.message().fizz, 2);
+
+    auto warning = StatusOptional<int, std::string>::warning(3, "warning");
+    std::expected<int, std::string> dropped = to_expected(warning, ExpectedWarning::DropMessage);
+    ASSERT_EQ(dropped.value(), 3);
+    std::expected<int, std::string> asError = to_expected(warning, ExpectedWarning::AsError);
+    ASSERT_EQ(asError.error(), "warning");
+    ASSERT_EQ(warning.message(), "warning");
+
+    std::expected<int, std::string> invalid = to_expected(StatusOptional<int, std::string>(), ExpectedWarning::DropMessage);
+    ASSERT_FALSE(invalid.has_value());
+    ASSERT_TRUE(invalid.error().empty());
+
+    std::expected<void, std::string> voidError = to_expected(StatusOptional<void, std::string>::error("error"), ExpectedWarning::DropMessage);
+    ASSERT_EQ(voidError.error(), "error");
+    ASSERT_TRUE(to_status_optional(std::expected<void, std::string>()).is_no_error_or_warning());
+
+    auto twice = [] (auto && result) {
+        return transform(and_then(result, [] (int val) { return std::remove_reference_t<decltype(result)>(val + 1); }), [] (int val) { return 2*val; });
+    };
+    ASSERT_EQ(twice(StatusOptional<int, std::string>(3)).value(), 8);
+    ASSERT_EQ(twice(std::expected<int, std::string>(3)).value(), 8);
+    ASSERT_EQ(transform_error(StatusOptional<int, std::string>::error("error"), [] (std::string const& msg) { return msg.size(); }).message(), 5u);
+    ASSERT_EQ(transform_error(std::expected<int, std::string>(std::unexpect, "error"), [] (std::string const& msg) { return msg.size(); }).error(), 5u);
+    ASSERT_EQ(or_else(std::expected<int, std::string>(std::unexpect, "error"), [] (std::string const&) { return std::expected<int, std::string>(0); }).value(), 0);
+}
+#endif